@@ -0,0 +1,253 @@
+#include "bf16.h"
+#include "matrix_expr.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+void bf16_to_floats(float* out, const bf16* in, size_t count) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Interleaving zero words below each value is the 16-bit shift
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i*)(in + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(zero, h));
+        _mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(zero, h));
+    }
+#endif
+    for (; i < count; i++) out[i] = bf16_to_float(in[i]);
+}
+
+#if defined(__SSE2__)
+// Round four floats to nearest even and return them in the low 16 bits of
+// each lane, sign-extended so that _mm_packs_epi32 keeps them exact
+static inline __m128i round_to_bf16(__m128i bits) {
+    __m128i lsb = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(1));
+    __m128i rounded = _mm_add_epi32(bits, _mm_add_epi32(lsb, _mm_set1_epi32(0x7FFF)));
+    __m128i quiet_nan = _mm_or_si128(bits, _mm_set1_epi32(0x400000));
+    __m128i is_nan = _mm_cmpgt_epi32(_mm_and_si128(bits, _mm_set1_epi32(0x7FFFFFFF)),
+                                     _mm_set1_epi32(0x7F800000));
+    rounded = _mm_or_si128(_mm_and_si128(is_nan, quiet_nan), _mm_andnot_si128(is_nan, rounded));
+    return _mm_srai_epi32(rounded, 16);
+}
+#endif
+
+void bf16_from_floats(bf16* out, const float* in, size_t count) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = round_to_bf16(_mm_castps_si128(_mm_loadu_ps(in + i)));
+        __m128i hi = round_to_bf16(_mm_castps_si128(_mm_loadu_ps(in + i + 4)));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; i++) out[i] = bf16_from_float(in[i]);
+}
+
+void bf16_from_doubles(bf16* out, const double* in, size_t count) {
+    float chunk[64];
+    for (size_t i = 0; i < count; i += 64) {
+        size_t n = count - i < 64 ? count - i : 64;
+        for (size_t j = 0; j < n; j++) chunk[j] = (float)in[i + j];
+        bf16_from_floats(out + i, chunk, n);
+    }
+}
+
+Bf16Matrix* bf16_matrix_create(int rows, int cols) {
+    Bf16Matrix* m = (Bf16Matrix*)malloc(sizeof(Bf16Matrix));
+    m->rows = rows;
+    m->cols = cols;
+    m->data = (bf16*)calloc((size_t)rows * cols, sizeof(bf16));
+    return m;
+}
+
+void bf16_matrix_store(Bf16Matrix* out, const Matrix* m) {
+    for (int i = 0; i < m->rows; i++) {
+        bf16_from_doubles(out->data + (size_t)i * out->cols, matrix_row(m, i), m->cols);
+    }
+}
+
+Bf16Matrix* bf16_matrix_from(const Matrix* m) {
+    Bf16Matrix* out = bf16_matrix_create(m->rows, m->cols);
+    bf16_matrix_store(out, m);
+    return out;
+}
+
+void bf16_matrix_free(Bf16Matrix* m) {
+    if (m == NULL) return;
+    free(m->data);
+    free(m);
+}
+
+size_t bf16_matrix_bytes(const Bf16Matrix* m) {
+    return (size_t)m->rows * m->cols * sizeof(bf16);
+}
+
+// Single-precision kernels; the sums stay in float
+static float dot_f32(const float* a, const float* b, int n) {
+    int i = 0;
+    float sum = 0.0f;
+#if defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+// Four dot products sharing one pass over a
+static void dot4_f32(double* out, const float* a, const float* b0, const float* b1,
+                     const float* b2, const float* b3, int n) {
+    int i = 0;
+    float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+#if defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(a + i);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(x, _mm_loadu_ps(b0 + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(x, _mm_loadu_ps(b1 + i)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(x, _mm_loadu_ps(b2 + i)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(x, _mm_loadu_ps(b3 + i)));
+    }
+    // Transpose so each lane of the total holds one column's sum
+    _MM_TRANSPOSE4_PS(acc0, acc1, acc2, acc3);
+    _mm_storeu_ps(sums, _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)));
+#endif
+    for (; i < n; i++) {
+        sums[0] += a[i] * b0[i];
+        sums[1] += a[i] * b1[i];
+        sums[2] += a[i] * b2[i];
+        sums[3] += a[i] * b3[i];
+    }
+    for (int j = 0; j < 4; j++) out[j] = sums[j];
+}
+
+int bf16_multiply(Matrix* out, const Bf16Matrix* w, const Bf16Matrix* x) {
+    if (w->cols != x->rows || out->rows != w->rows || out->cols != x->cols) {
+        fprintf(stderr, "Error: bf16_multiply: (%d,%d) x (%d,%d) into (%d,%d)\n",
+                w->rows, w->cols, x->rows, x->cols, out->rows, out->cols);
+        return 1;
+    }
+    int k = w->cols;
+    int batch = x->cols;
+
+    // The inputs are widened once, transposed so each example is a
+    // contiguous vector; weight rows are widened as they are reached
+    float* xt = (float*)malloc((size_t)k * batch * sizeof(float));
+    float* row = (float*)malloc((size_t)(k > batch ? k : batch) * sizeof(float));
+    for (int p = 0; p < k; p++) {
+        bf16_to_floats(row, x->data + (size_t)p * batch, batch);
+        for (int j = 0; j < batch; j++) xt[(size_t)j * k + p] = row[j];
+    }
+
+    for (int i = 0; i < w->rows; i++) {
+        bf16_to_floats(row, w->data + (size_t)i * k, k);
+        double* result = matrix_row(out, i);
+        int j = 0;
+        for (; j + 4 <= batch; j += 4) {
+            const float* col = xt + (size_t)j * k;
+            dot4_f32(result + j, row, col, col + k, col + 2 * k, col + 3 * k, k);
+        }
+        for (; j < batch; j++) result[j] = dot_f32(row, xt + (size_t)j * k, k);
+    }
+
+    free(xt);
+    free(row);
+    return 0;
+}
+
+Bf16Network* bf16_network_create(const NeuralNetwork* nn) {
+    if (nn->num_layers <= 0) {
+        fprintf(stderr, "Error: bf16 inference needs at least one layer\n");
+        return NULL;
+    }
+    for (int i = 0; i < nn->num_layers; i++) {
+        if (nn->layers[i]->type != LAYER_DENSE) {
+            fprintf(stderr, "Error: bf16 inference supports dense layers only (layer %d)\n", i);
+            return NULL;
+        }
+    }
+
+    Bf16Network* net = (Bf16Network*)malloc(sizeof(Bf16Network));
+    net->num_layers = nn->num_layers;
+    net->weights = (Bf16Matrix**)malloc(nn->num_layers * sizeof(Bf16Matrix*));
+    net->biases = (float**)malloc(nn->num_layers * sizeof(float*));
+    net->activations = (ActivationType*)malloc(nn->num_layers * sizeof(ActivationType));
+    net->inputs = (Bf16Matrix**)calloc(nn->num_layers, sizeof(Bf16Matrix*));
+    net->outputs = (Matrix**)calloc(nn->num_layers, sizeof(Matrix*));
+
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        net->weights[i] = bf16_matrix_from(layer->weights);
+        net->biases[i] = (float*)malloc(layer->output_size * sizeof(float));
+        for (int r = 0; r < layer->output_size; r++) {
+            net->biases[i][r] = (float)MATRIX_AT(layer->biases, r, 0);
+        }
+        net->activations[i] = layer->activation;
+    }
+    return net;
+}
+
+void bf16_network_free(Bf16Network* net) {
+    if (net == NULL) return;
+    for (int i = 0; i < net->num_layers; i++) {
+        bf16_matrix_free(net->weights[i]);
+        free(net->biases[i]);
+        bf16_matrix_free(net->inputs[i]);
+        matrix_free(net->outputs[i]);
+    }
+    free(net->weights);
+    free(net->biases);
+    free(net->activations);
+    free(net->inputs);
+    free(net->outputs);
+    free(net);
+}
+
+Matrix* bf16_network_forward(Bf16Network* net, const Matrix* input) {
+    if (input->rows != net->weights[0]->cols) {
+        fprintf(stderr, "Error: bf16_network_forward: input has %d rows, the network takes %d\n",
+                input->rows, net->weights[0]->cols);
+        return NULL;
+    }
+    int batch = input->cols;
+    for (int i = 0; i < net->num_layers; i++) {
+        if (net->outputs[i] == NULL || net->outputs[i]->cols != batch) {
+            bf16_matrix_free(net->inputs[i]);
+            matrix_free(net->outputs[i]);
+            net->inputs[i] = bf16_matrix_create(net->weights[i]->cols, batch);
+            net->outputs[i] = matrix_create(net->weights[i]->rows, batch);
+        }
+    }
+
+    bf16_matrix_store(net->inputs[0], input);
+    Matrix* out = NULL;
+    for (int i = 0; i < net->num_layers; i++) {
+        out = net->outputs[i];
+        if (bf16_multiply(out, net->weights[i], net->inputs[i])) return NULL;
+        for (int r = 0; r < out->rows; r++) {
+            double* row = matrix_row(out, r);
+            for (int j = 0; j < batch; j++) row[j] += net->biases[i][r];
+        }
+        activation_forward(out, out, net->activations[i]);
+        if (i + 1 < net->num_layers) bf16_matrix_store(net->inputs[i + 1], out);
+    }
+    return out;
+}
+
+size_t bf16_network_bytes(const Bf16Network* net) {
+    size_t bytes = 0;
+    for (int i = 0; i < net->num_layers; i++) {
+        bytes += bf16_matrix_bytes(net->weights[i]) + net->weights[i]->rows * sizeof(float);
+    }
+    return bytes;
+}
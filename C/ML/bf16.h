@@ -0,0 +1,72 @@
+#ifndef BF16_H
+#define BF16_H
+
+#include "neural_network.h"
+
+// bfloat16: the upper half of an IEEE float (sign, 8-bit exponent, 7-bit
+// mantissa). Same range as float with about 3 significant digits, and
+// conversion to float is a 16-bit shift.
+typedef uint16_t bf16;
+
+static inline float bf16_to_float(bf16 h) {
+    uint32_t bits = (uint32_t)h << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Round to nearest even; NaNs stay (quiet) NaNs
+static inline bf16 bf16_from_float(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7FFFFFFFu) > 0x7F800000u) return (bf16)((bits >> 16) | 0x40);
+    bits += 0x7FFFu + ((bits >> 16) & 1);
+    return (bf16)(bits >> 16);
+}
+
+// Bulk conversions, eight values per step with SSE2 where available
+void bf16_to_floats(float* out, const bf16* in, size_t count);
+void bf16_from_floats(bf16* out, const float* in, size_t count);
+void bf16_from_doubles(bf16* out, const double* in, size_t count);
+
+// Contiguous row-major bf16 matrix
+typedef struct {
+    int rows;
+    int cols;
+    bf16* data;
+} Bf16Matrix;
+
+Bf16Matrix* bf16_matrix_create(int rows, int cols);
+Bf16Matrix* bf16_matrix_from(const Matrix* m);
+void bf16_matrix_free(Bf16Matrix* m);
+// Convert m into an existing bf16 matrix of the same shape
+void bf16_matrix_store(Bf16Matrix* out, const Matrix* m);
+size_t bf16_matrix_bytes(const Bf16Matrix* m);
+
+// out = w * x with bf16 operands widened to float as they are loaded and
+// products accumulated in float; x holds one column per example. Returns
+// 1 on a shape mismatch.
+int bf16_multiply(Matrix* out, const Bf16Matrix* w, const Bf16Matrix* x);
+
+// Inference-only copy of a dense network with bf16 weights. Each layer's
+// input (the activation passed between layers) is also kept in bf16, so
+// weight and activation reads take a quarter of the bytes of double.
+// Biases stay in float; activations are computed in double.
+typedef struct {
+    int num_layers;
+    Bf16Matrix** weights;
+    float** biases;
+    ActivationType* activations;
+    Bf16Matrix** inputs;   // bf16 input of each layer, reused while the batch size is unchanged
+    Matrix** outputs;      // Per-layer results before conversion for the next layer
+} Bf16Network;
+
+Bf16Network* bf16_network_create(const NeuralNetwork* nn);
+void bf16_network_free(Bf16Network* net);
+// Result is owned by the network and valid until the next call; NULL if
+// the input does not have one row per network input
+Matrix* bf16_network_forward(Bf16Network* net, const Matrix* input);
+// Parameter bytes (weights and biases)
+size_t bf16_network_bytes(const Bf16Network* net);
+
+#endif
@@ -0,0 +1,363 @@
+#include "checkpoint.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_layers;
+    uint32_t epochs_completed;
+    double learning_rate;
+    uint64_t seed;
+    uint64_t payload_bytes;
+    uint64_t checksum;  // FNV-1a over the payload
+} CheckpointHeader;
+
+typedef struct {
+    int32_t type;
+    int32_t pooling;
+    int32_t input_size;
+    int32_t output_size;
+    int32_t activation;
+    int32_t has_mask;
+    int32_t conv_channels;     // Conv1DShape of convolution layers, else 0
+    int32_t conv_length;
+    int32_t conv_kernel_size;
+    int32_t conv_filters;
+    int32_t conv_pool_size;
+} CheckpointLayer;
+
+static uint64_t fnv1a(const char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static size_t matrix_bytes(const Matrix* m) {
+    return m ? (size_t)m->rows * m->cols * sizeof(double) : 0;
+}
+
+static char* put_matrix(char* out, const Matrix* m) {
+    if (m == NULL) return out;
+    for (int i = 0; i < m->rows; i++) {
+        memcpy(out, matrix_row(m, i), m->cols * sizeof(double));
+        out += m->cols * sizeof(double);
+    }
+    return out;
+}
+
+static const char* get_matrix(const char* in, Matrix* m) {
+    for (int i = 0; i < m->rows; i++) {
+        memcpy(matrix_row(m, i), in, m->cols * sizeof(double));
+        in += m->cols * sizeof(double);
+    }
+    return in;
+}
+
+// Serialize the network into buffer, growing it if needed
+static void serialize(CheckpointBuffer* buffer, const NeuralNetwork* nn, int epochs_completed) {
+    size_t size = sizeof(CheckpointHeader);
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        size += sizeof(CheckpointLayer) + matrix_bytes(layer->weights) + matrix_bytes(layer->biases) +
+                matrix_bytes(layer->mask);
+    }
+    if (size > buffer->capacity) {
+        free(buffer->data);
+        buffer->data = (char*)malloc(size);
+        buffer->capacity = size;
+    }
+    buffer->size = size;
+
+    char* out = buffer->data + sizeof(CheckpointHeader);
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        CheckpointLayer info = { layer->type, layer->pooling, layer->input_size, layer->output_size,
+                                 layer->activation, layer->mask != NULL,
+                                 layer->conv.channels, layer->conv.length, layer->conv.kernel_size,
+                                 layer->conv.filters, layer->conv.pool_size };
+        memcpy(out, &info, sizeof(info));
+        out += sizeof(info);
+        out = put_matrix(out, layer->weights);
+        out = put_matrix(out, layer->biases);
+        out = put_matrix(out, layer->mask);
+    }
+
+    CheckpointHeader header;
+    memcpy(header.magic, CHECKPOINT_MAGIC, 4);
+    header.version = CHECKPOINT_VERSION;
+    header.num_layers = nn->num_layers;
+    header.epochs_completed = epochs_completed;
+    header.learning_rate = nn->learning_rate;
+    header.seed = nn->seed;
+    header.payload_bytes = size - sizeof(CheckpointHeader);
+    header.checksum = 0;
+    memcpy(buffer->data, &header, sizeof(header));
+}
+
+// Checksum the payload; done by the writer so snapshots stay a plain copy
+static void seal(CheckpointBuffer* buffer) {
+    CheckpointHeader header;
+    memcpy(&header, buffer->data, sizeof(header));
+    header.checksum = fnv1a(buffer->data + sizeof(header), header.payload_bytes);
+    memcpy(buffer->data, &header, sizeof(header));
+}
+
+// Write, fsync, then atomically replace `path`; the directory is synced so
+// the rename itself survives a crash
+static int write_durably(const char* path, const char* data, size_t size) {
+    size_t path_length = strlen(path);
+    char* tmp_path = (char*)malloc(path_length + 5);
+    snprintf(tmp_path, path_length + 5, "%s.tmp", path);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not create checkpoint '%s'\n", tmp_path);
+        free(tmp_path);
+        return 1;
+    }
+
+    int status = 0;
+    while (size > 0 && status == 0) {
+        ssize_t n = write(fd, data, size);
+        if (n <= 0) {
+            status = 1;
+        } else {
+            data += n;
+            size -= n;
+        }
+    }
+    if (status == 0 && fsync(fd) != 0) status = 1;
+    if (close(fd) != 0) status = 1;
+    if (status == 0 && rename(tmp_path, path) != 0) status = 1;
+
+    if (status == 0) {
+        char* dir = (char*)malloc(path_length + 2);
+        const char* slash = strrchr(path, '/');
+        if (slash) {
+            memcpy(dir, path, slash - path + 1);
+            dir[slash - path + 1] = '\0';
+        } else {
+            strcpy(dir, ".");
+        }
+        int dir_fd = open(dir, O_RDONLY);
+        if (dir_fd >= 0) {
+            fsync(dir_fd);
+            close(dir_fd);
+        }
+        free(dir);
+    } else {
+        fprintf(stderr, "Error: Could not write checkpoint '%s'\n", path);
+        unlink(tmp_path);
+    }
+
+    free(tmp_path);
+    return status;
+}
+
+int nn_save_checkpoint(const NeuralNetwork* nn, int epochs_completed, const char* path) {
+    CheckpointBuffer buffer = { NULL, 0, 0 };
+    serialize(&buffer, nn, epochs_completed);
+    seal(&buffer);
+    int status = write_durably(path, buffer.data, buffer.size);
+    free(buffer.data);
+    return status;
+}
+
+int nn_load_checkpoint(NeuralNetwork* nn, const char* path, int* epochs_completed) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return 1;
+
+    CheckpointHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, CHECKPOINT_MAGIC, 4) != 0 || header.version != CHECKPOINT_VERSION) {
+        fprintf(stderr, "Error: '%s' is not a checkpoint\n", path);
+        fclose(file);
+        return 1;
+    }
+    if ((int)header.num_layers != nn->num_layers) {
+        fprintf(stderr, "Error: Checkpoint has %u layers, network has %d\n", header.num_layers, nn->num_layers);
+        fclose(file);
+        return 1;
+    }
+
+    char* payload = (char*)malloc(header.payload_bytes > 0 ? header.payload_bytes : 1);
+    int status = fread(payload, 1, header.payload_bytes, file) != header.payload_bytes ||
+                 fnv1a(payload, header.payload_bytes) != header.checksum;
+    fclose(file);
+    if (status) {
+        fprintf(stderr, "Error: Checkpoint '%s' is truncated or corrupt\n", path);
+        free(payload);
+        return 1;
+    }
+
+    // Check every layer before changing anything
+    const char* in = payload;
+    const char* end = payload + header.payload_bytes;
+    for (int i = 0; i < nn->num_layers && status == 0; i++) {
+        Layer* layer = nn->layers[i];
+        CheckpointLayer info;
+        if (end - in < (long)sizeof(info)) {
+            status = 1;
+            break;
+        }
+        memcpy(&info, in, sizeof(info));
+        if (info.type != (int32_t)layer->type || info.pooling != (int32_t)layer->pooling ||
+            info.input_size != layer->input_size || info.output_size != layer->output_size ||
+            info.activation != (int32_t)layer->activation ||
+            info.conv_channels != layer->conv.channels || info.conv_length != layer->conv.length ||
+            info.conv_kernel_size != layer->conv.kernel_size || info.conv_filters != layer->conv.filters ||
+            info.conv_pool_size != layer->conv.pool_size) {
+            fprintf(stderr, "Error: Checkpoint layer %d does not match the network\n", i);
+            status = 1;
+        }
+        in += sizeof(info) + matrix_bytes(layer->weights) + matrix_bytes(layer->biases) +
+              (info.has_mask ? matrix_bytes(layer->weights) : 0);
+    }
+    if (status == 0 && in != end) {
+        fprintf(stderr, "Error: Checkpoint '%s' does not match the network\n", path);
+        status = 1;
+    }
+
+    in = payload;
+    for (int i = 0; i < nn->num_layers && status == 0; i++) {
+        Layer* layer = nn->layers[i];
+        CheckpointLayer info;
+        memcpy(&info, in, sizeof(info));
+        in += sizeof(info);
+        in = get_matrix(in, layer->weights);
+        if (layer->biases) in = get_matrix(in, layer->biases);
+
+        if (info.has_mask) {
+            if (layer->mask == NULL) layer->mask = matrix_create(layer->weights->rows, layer->weights->cols);
+            in = get_matrix(in, layer->mask);
+        } else if (layer->mask) {
+            matrix_free(layer->mask);
+            layer->mask = NULL;
+        }
+    }
+
+    if (status == 0) {
+        nn->learning_rate = header.learning_rate;
+        nn->seed = header.seed;
+        if (epochs_completed) *epochs_completed = (int)header.epochs_completed;
+    }
+    free(payload);
+    return status;
+}
+
+static void* writer_thread(void* arg) {
+    Checkpointer* c = (Checkpointer*)arg;
+
+    pthread_mutex_lock(&c->lock);
+    for (;;) {
+        while (!c->pending_ready && !c->stop) {
+            pthread_cond_wait(&c->work_ready, &c->lock);
+        }
+        if (!c->pending_ready) break;  // Stopping with nothing queued
+
+        // Take the snapshot; the training thread fills the other buffer next
+        CheckpointBuffer taken = c->pending;
+        c->pending = c->writing;
+        c->writing = taken;
+        c->pending_ready = 0;
+        c->write_active = 1;
+        pthread_mutex_unlock(&c->lock);
+
+        double start = profiler_now();
+        seal(&c->writing);
+        int status = write_durably(c->path, c->writing.data, c->writing.size);
+        double elapsed = profiler_now() - start;
+
+        pthread_mutex_lock(&c->lock);
+        c->write_active = 0;
+        c->write_seconds += elapsed;
+        if (status) c->failures++;
+        else c->writes++;
+        pthread_cond_broadcast(&c->work_done);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+Checkpointer* checkpointer_create(const char* path, int every_epochs) {
+    Checkpointer* c = (Checkpointer*)calloc(1, sizeof(Checkpointer));
+    c->path = strdup(path);
+    c->every_epochs = every_epochs > 0 ? every_epochs : 1;
+
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->work_ready, NULL);
+    pthread_cond_init(&c->work_done, NULL);
+    if (pthread_create(&c->thread, NULL, writer_thread, c) != 0) {
+        fprintf(stderr, "Error: Could not start the checkpoint writer\n");
+        pthread_mutex_destroy(&c->lock);
+        pthread_cond_destroy(&c->work_ready);
+        pthread_cond_destroy(&c->work_done);
+        free(c->path);
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+void checkpointer_free(Checkpointer* c) {
+    if (c == NULL) return;
+
+    // The writer drains the queued snapshot before it exits
+    pthread_mutex_lock(&c->lock);
+    c->stop = 1;
+    pthread_cond_signal(&c->work_ready);
+    pthread_mutex_unlock(&c->lock);
+    pthread_join(c->thread, NULL);
+
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->work_ready);
+    pthread_cond_destroy(&c->work_done);
+    free(c->pending.data);
+    free(c->writing.data);
+    free(c->path);
+    free(c);
+}
+
+int checkpointer_resume(Checkpointer* c, NeuralNetwork* nn) {
+    int epochs_completed = 0;
+    if (access(c->path, F_OK) != 0 || nn_load_checkpoint(nn, c->path, &epochs_completed)) {
+        return 0;
+    }
+    c->start_epoch = epochs_completed;
+    return epochs_completed;
+}
+
+int checkpointer_start_epoch(Checkpointer* c) {
+    int start = c->start_epoch;
+    c->start_epoch = 0;
+    return start;
+}
+
+void checkpointer_end_epoch(Checkpointer* c, const NeuralNetwork* nn, int epoch, int epochs) {
+    if ((epoch + 1) % c->every_epochs != 0 && epoch + 1 != epochs) return;
+    checkpointer_snapshot(c, nn, epoch);
+}
+
+void checkpointer_snapshot(Checkpointer* c, const NeuralNetwork* nn, int epoch) {
+    double start = profiler_now();
+    pthread_mutex_lock(&c->lock);
+    if (c->pending_ready) c->superseded++;
+    serialize(&c->pending, nn, epoch + 1);
+    c->pending_ready = 1;
+    c->snapshots++;
+    pthread_cond_signal(&c->work_ready);
+    pthread_mutex_unlock(&c->lock);
+    c->snapshot_seconds += profiler_now() - start;
+}
+
+void checkpointer_flush(Checkpointer* c) {
+    pthread_mutex_lock(&c->lock);
+    while (c->pending_ready || c->write_active) {
+        pthread_cond_wait(&c->work_done, &c->lock);
+    }
+    pthread_mutex_unlock(&c->lock);
+}
@@ -0,0 +1,77 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <pthread.h>
+#include "neural_network.h"
+
+// Checkpoint file: a fixed header followed by, per layer, its shape
+// (including the convolution geometry) and activation, the weights, the
+// biases and the pruning mask if present.
+// The header stores the completed epochs and the training state (learning
+// rate, initialization seed; plain SGD keeps no other optimizer state)
+// and a checksum over everything after it.
+#define CHECKPOINT_MAGIC "NNCK"
+#define CHECKPOINT_VERSION 2
+
+// Synchronous save, written to `path`.tmp, fsync'ed and renamed over
+// `path` so a crash never leaves a torn checkpoint. Returns 1 on failure.
+int nn_save_checkpoint(const NeuralNetwork* nn, int epochs_completed, const char* path);
+// Restore into a network built with the same architecture. Returns 1 if
+// the file is missing, corrupt or does not match.
+int nn_load_checkpoint(NeuralNetwork* nn, const char* path, int* epochs_completed);
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} CheckpointBuffer;
+
+// Periodic checkpoints without stalling training. Attach with
+// `nn->checkpointer = checkpointer;` (not owned by the network). At the end
+// of every `every_epochs`-th epoch the training loops copy the parameters
+// into a memory buffer, which is all the training thread pays for; a
+// background thread serializes and fsyncs it. If a write is still in
+// progress when the next snapshot is taken, the newest snapshot replaces
+// the queued one.
+typedef struct Checkpointer {
+    char* path;
+    int every_epochs;
+    int start_epoch;          // Set by checkpointer_resume(), consumed by the next training call
+
+    CheckpointBuffer pending;  // Latest snapshot, not yet picked up
+    CheckpointBuffer writing;  // Owned by the writer thread while a write runs
+    int pending_ready;
+    int write_active;
+    int stop;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+
+    // Statistics
+    long snapshots;
+    long writes;
+    long superseded;           // Snapshots replaced before they were written
+    long failures;
+    double snapshot_seconds;   // Spent on the training thread
+    double write_seconds;      // Spent on the writer thread
+} Checkpointer;
+
+Checkpointer* checkpointer_create(const char* path, int every_epochs);
+// Waits for the queued snapshot to be written
+void checkpointer_free(Checkpointer* checkpointer);
+// Load the checkpoint at the checkpointer's path into nn if there is one,
+// so that the next nn_train* call continues after the saved epoch.
+// Returns the number of completed epochs, 0 when starting fresh.
+int checkpointer_resume(Checkpointer* checkpointer, NeuralNetwork* nn);
+// Called by the training loops: the first epoch to run, then after each
+// epoch (snapshots every every_epochs epochs and after the last one)
+int checkpointer_start_epoch(Checkpointer* checkpointer);
+void checkpointer_end_epoch(Checkpointer* checkpointer, const NeuralNetwork* nn, int epoch, int epochs);
+// Queue a snapshot after `epoch` regardless of the schedule
+void checkpointer_snapshot(Checkpointer* checkpointer, const NeuralNetwork* nn, int epoch);
+// Block until every snapshot taken so far is on disk
+void checkpointer_flush(Checkpointer* checkpointer);
+
+#endif
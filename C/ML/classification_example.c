@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "neural_network.h"
+#include "prune.h"
+#include "bf16.h"
+
+#define NUM_CLASSES 3
+#define POINTS_PER_CLASS 60
+#define MAX_EPOCHS 1000
+#define TARGET_ACCURACY 0.95
+#define PRUNE_SPARSITY 0.8
+#define PRUNE_BLOCK 2
+
+// Generate three interleaved spiral arms, one class per arm
+void generate_spirals(Matrix** inputs, Matrix** targets) {
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        for (int i = 0; i < POINTS_PER_CLASS; i++) {
+            int index = c * POINTS_PER_CLASS + i;
+            double r = (double)i / POINTS_PER_CLASS;
+            double noise = ((double)rand() / RAND_MAX - 0.5) * 0.2;
+            double theta = c * 2.0 * M_PI / NUM_CLASSES + r * 2.0 * M_PI + noise;
+
+            inputs[index] = matrix_create(2, 1);
+            matrix_set(inputs[index], 0, 0, r * cos(theta));
+            matrix_set(inputs[index], 1, 0, r * sin(theta));
+
+            // One-hot target
+            targets[index] = matrix_create(NUM_CLASSES, 1);
+            matrix_set(targets[index], c, 0, 1.0);
+        }
+    }
+}
+
+int predicted_class(Matrix* output) {
+    int best = 0;
+    for (int k = 1; k < output->rows; k++) {
+        if (matrix_get(output, k, 0) > matrix_get(output, best, 0)) best = k;
+    }
+    return best;
+}
+
+double sparse_accuracy(SparseNetwork* sparse, Matrix** inputs, Matrix** targets, int num_samples) {
+    int correct = 0;
+    for (int i = 0; i < num_samples; i++) {
+        Matrix* output = sparse_network_forward(sparse, inputs[i]);
+        if (matrix_get(targets[i], predicted_class(output), 0) == 1.0) correct++;
+    }
+    return (double)correct / num_samples;
+}
+
+double bf16_accuracy(Bf16Network* half, Matrix** inputs, Matrix** targets, int num_samples) {
+    int correct = 0;
+    for (int i = 0; i < num_samples; i++) {
+        Matrix* output = bf16_network_forward(half, inputs[i]);
+        if (matrix_get(targets[i], predicted_class(output), 0) == 1.0) correct++;
+    }
+    return (double)correct / num_samples;
+}
+
+double accuracy(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples) {
+    int correct = 0;
+    for (int i = 0; i < num_samples; i++) {
+        Matrix* output = nn_forward(nn, inputs[i]);
+        if (matrix_get(targets[i], predicted_class(output), 0) == 1.0) correct++;
+    }
+    return (double)correct / num_samples;
+}
+
+// Train until the target accuracy is reached; returns the epochs needed
+int train_until_accurate(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples,
+                         double* final_accuracy) {
+    for (int epoch = 0; epoch < MAX_EPOCHS; epoch++) {
+        // Visit samples in a shuffled order each epoch
+        for (int i = 0; i < num_samples; i++) {
+            int j = i + rand() % (num_samples - i);
+            Matrix* tmp = inputs[i]; inputs[i] = inputs[j]; inputs[j] = tmp;
+            tmp = targets[i]; targets[i] = targets[j]; targets[j] = tmp;
+            nn_train_sample(nn, inputs[i], targets[i]);
+        }
+
+        *final_accuracy = accuracy(nn, inputs, targets, num_samples);
+        if (*final_accuracy >= TARGET_ACCURACY) return epoch + 1;
+    }
+    return -1;
+}
+
+NeuralNetwork* create_classifier(ActivationType output_activation, double learning_rate) {
+    NeuralNetwork* nn = nn_create(3);
+    nn_add_layer(nn, 0, 2, 32, ACTIVATION_TANH);
+    nn_add_layer(nn, 1, 32, 32, ACTIVATION_TANH);
+    nn_add_layer(nn, 2, 32, NUM_CLASSES, output_activation);
+    nn->learning_rate = learning_rate;
+    return nn;
+}
+
+int main() {
+    srand(time(NULL));
+
+    printf("=== Multi-Class Classification Example ===\n\n");
+    printf("Classifying points on %d interleaved spirals\n", NUM_CLASSES);
+    printf("Architecture: 2 -> 32 -> 32 -> %d\n", NUM_CLASSES);
+    printf("Goal: %.0f%% training accuracy (max %d epochs)\n\n", TARGET_ACCURACY * 100, MAX_EPOCHS);
+
+    int num_samples = NUM_CLASSES * POINTS_PER_CLASS;
+    Matrix** inputs = (Matrix**)malloc(num_samples * sizeof(Matrix*));
+    Matrix** targets = (Matrix**)malloc(num_samples * sizeof(Matrix*));
+    generate_spirals(inputs, targets);
+
+    struct {
+        const char* name;
+        ActivationType output;
+        double learning_rate;
+    } variants[] = {
+        { "Independent sigmoids + MSE", ACTIVATION_SIGMOID, 0.3 },
+        { "Softmax + cross-entropy   ", ACTIVATION_SOFTMAX, 0.05 }
+    };
+
+    for (int v = 0; v < 2; v++) {
+        NeuralNetwork* nn = create_classifier(variants[v].output, variants[v].learning_rate);
+
+        clock_t start = clock();
+        double final_accuracy = 0.0;
+        int epochs = train_until_accurate(nn, inputs, targets, num_samples, &final_accuracy);
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        if (epochs > 0) {
+            printf("%s: reached %.1f%% after %4d epochs (%.2fs)\n",
+                   variants[v].name, final_accuracy * 100, epochs, seconds);
+        } else {
+            printf("%s: only %.1f%% after %4d epochs (%.2fs)\n",
+                   variants[v].name, final_accuracy * 100, MAX_EPOCHS, seconds);
+        }
+
+        nn_free(nn);
+    }
+
+    // Show class probabilities from a freshly trained softmax model
+    NeuralNetwork* nn = create_classifier(ACTIVATION_SOFTMAX, 0.05);
+    double final_accuracy = 0.0;
+    train_until_accurate(nn, inputs, targets, num_samples, &final_accuracy);
+
+    printf("\n=== Softmax Predictions ===\n\n");
+    for (int i = 0; i < 5; i++) {
+        Matrix* output = nn_forward(nn, inputs[i]);
+        printf("Point (%6.3f, %6.3f): P = [", matrix_get(inputs[i], 0, 0), matrix_get(inputs[i], 1, 0));
+        for (int k = 0; k < NUM_CLASSES; k++) {
+            printf("%s%.3f", k ? ", " : "", matrix_get(output, k, 0));
+        }
+        printf("] -> class %d (actual %d)\n", predicted_class(output),
+               predicted_class(targets[i]));
+    }
+    printf("\n");
+
+    // The same model with bf16 weights and activations
+    printf("=== bfloat16 Inference ===\n\n");
+    Bf16Network* half = bf16_network_create(nn);
+    printf("Accuracy: %.1f%% double, %.1f%% bf16\n", accuracy(nn, inputs, targets, num_samples) * 100,
+           bf16_accuracy(half, inputs, targets, num_samples) * 100);
+    printf("Model size: %zu bytes double, %zu bytes bf16\n\n", nn_parameter_bytes(nn),
+           bf16_network_bytes(half));
+    bf16_network_free(half);
+
+    // Prune the trained model, fine-tune with the pruned weights held at
+    // zero, and run it with block-sparse weights
+    printf("=== Pruning ===\n\n");
+    double dense_accuracy = accuracy(nn, inputs, targets, num_samples);
+    nn_prune(nn, PRUNE_SPARSITY, PRUNE_BLOCK, PRUNE_BLOCK);
+    printf("Pruned %.0f%% of weights in %dx%d blocks\n", nn_weight_sparsity(nn) * 100,
+           PRUNE_BLOCK, PRUNE_BLOCK);
+    printf("Accuracy: %.1f%% dense, %.1f%% pruned", dense_accuracy * 100,
+           accuracy(nn, inputs, targets, num_samples) * 100);
+    int fine_tune_epochs = train_until_accurate(nn, inputs, targets, num_samples, &final_accuracy);
+    printf(", %.1f%% after %d fine-tuning epochs\n", final_accuracy * 100,
+           fine_tune_epochs > 0 ? fine_tune_epochs : MAX_EPOCHS);
+
+    SparseNetwork* sparse = sparse_network_create(nn, PRUNE_BLOCK, PRUNE_BLOCK);
+    printf("Sparse inference accuracy: %.1f%%\n", sparse_accuracy(sparse, inputs, targets, num_samples) * 100);
+    printf("Model size: %zu bytes dense, %zu bytes sparse\n\n", nn_parameter_bytes(nn),
+           sparse_network_bytes(sparse));
+    sparse_network_free(sparse);
+
+    // Cleanup
+    for (int i = 0; i < num_samples; i++) {
+        matrix_free(inputs[i]);
+        matrix_free(targets[i]);
+    }
+    free(inputs);
+    free(targets);
+    nn_free(nn);
+
+    return 0;
+}
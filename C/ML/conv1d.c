@@ -0,0 +1,247 @@
+#include "conv1d.h"
+
+int conv1d_shape_init(Conv1DShape* shape, int channels, int length, int kernel_size,
+                      int filters, int pool_size) {
+    if (channels < 1 || filters < 1 || kernel_size < 1 || kernel_size > length ||
+        pool_size < 1 || pool_size > length - kernel_size + 1) {
+        return 1;
+    }
+    shape->channels = channels;
+    shape->length = length;
+    shape->kernel_size = kernel_size;
+    shape->filters = filters;
+    shape->conv_length = length - kernel_size + 1;
+    shape->pool_size = pool_size;
+    shape->pooled_length = shape->conv_length / pool_size;
+    return 0;
+}
+
+int conv1d_uses_direct(const Conv1DShape* shape) {
+    return shape->channels * shape->kernel_size <= CONV1D_DIRECT_MAX_TAPS;
+}
+
+void conv1d_im2col(const Conv1DShape* shape, const Matrix* input, Matrix* columns) {
+    int batch = input->cols;
+    for (int c = 0; c < shape->channels; c++) {
+        for (int i = 0; i < shape->kernel_size; i++) {
+            double* out = matrix_row(columns, c * shape->kernel_size + i);
+            for (int t = 0; t < shape->conv_length; t++) {
+                memcpy(out + (size_t)t * batch, matrix_row(input, c * shape->length + t + i),
+                       batch * sizeof(double));
+            }
+        }
+    }
+}
+
+void conv1d_col2im(const Conv1DShape* shape, const Matrix* columns, Matrix* input_grad) {
+    int batch = input_grad->cols;
+    matrix_fill(input_grad, 0.0);
+    for (int c = 0; c < shape->channels; c++) {
+        for (int i = 0; i < shape->kernel_size; i++) {
+            const double* in = matrix_row(columns, c * shape->kernel_size + i);
+            for (int t = 0; t < shape->conv_length; t++) {
+                double* grad = matrix_row(input_grad, c * shape->length + t + i);
+                const double* src = in + (size_t)t * batch;
+                for (int j = 0; j < batch; j++) grad[j] += src[j];
+            }
+        }
+    }
+}
+
+void conv1d_direct(const Conv1DShape* shape, const Matrix* weights, const Matrix* input, Matrix* conv_out) {
+    int batch = input->cols;
+    for (int f = 0; f < shape->filters; f++) {
+        double* out = matrix_row(conv_out, f);
+        const double* w = matrix_row(weights, f);
+        memset(out, 0, (size_t)shape->conv_length * batch * sizeof(double));
+
+        for (int c = 0; c < shape->channels; c++) {
+            for (int i = 0; i < shape->kernel_size; i++) {
+                double tap = w[c * shape->kernel_size + i];
+                for (int t = 0; t < shape->conv_length; t++) {
+                    const double* x = matrix_row(input, c * shape->length + t + i);
+                    double* o = out + (size_t)t * batch;
+                    for (int j = 0; j < batch; j++) o[j] += tap * x[j];
+                }
+            }
+        }
+    }
+}
+
+void conv1d_pool(const Conv1DShape* shape, PoolingType pooling, const Matrix* conv_out, Matrix* pooled) {
+    int batch = pooled->cols;
+    double scale = 1.0 / shape->pool_size;
+    for (int f = 0; f < shape->filters; f++) {
+        const double* in = matrix_row(conv_out, f);
+        for (int p = 0; p < shape->pooled_length; p++) {
+            double* out = matrix_row(pooled, f * shape->pooled_length + p);
+            const double* window = in + (size_t)p * shape->pool_size * batch;
+            memcpy(out, window, batch * sizeof(double));
+
+            for (int t = 1; t < shape->pool_size; t++) {
+                const double* x = window + (size_t)t * batch;
+                if (pooling == POOLING_MAX) {
+                    for (int j = 0; j < batch; j++) out[j] = x[j] > out[j] ? x[j] : out[j];
+                } else {
+                    for (int j = 0; j < batch; j++) out[j] += x[j];
+                }
+            }
+            if (pooling != POOLING_MAX && shape->pool_size > 1) {
+                for (int j = 0; j < batch; j++) out[j] *= scale;
+            }
+        }
+    }
+}
+
+void conv1d_unpool(const Conv1DShape* shape, PoolingType pooling, const Matrix* conv_out,
+                   const Matrix* pooled_grad, Matrix* conv_grad) {
+    int batch = pooled_grad->cols;
+    double scale = 1.0 / shape->pool_size;
+    matrix_fill(conv_grad, 0.0);
+    for (int f = 0; f < shape->filters; f++) {
+        const double* in = matrix_row(conv_out, f);
+        double* grad = matrix_row(conv_grad, f);
+        for (int p = 0; p < shape->pooled_length; p++) {
+            const double* g = matrix_row(pooled_grad, f * shape->pooled_length + p);
+            size_t window = (size_t)p * shape->pool_size * batch;
+
+            if (pooling != POOLING_MAX) {
+                for (int t = 0; t < shape->pool_size; t++) {
+                    double* out = grad + window + (size_t)t * batch;
+                    for (int j = 0; j < batch; j++) out[j] = g[j] * scale;
+                }
+                continue;
+            }
+
+            // The first position holding the maximum, as conv1d_pool kept it
+            for (int j = 0; j < batch; j++) {
+                int best = 0;
+                for (int t = 1; t < shape->pool_size; t++) {
+                    if (in[window + (size_t)t * batch + j] > in[window + (size_t)best * batch + j]) best = t;
+                }
+                grad[window + (size_t)best * batch + j] = g[j];
+            }
+        }
+    }
+}
+
+// Reallocate a cache matrix when the batch size changes
+static Matrix* ensure_shape(Matrix* m, int rows, int cols) {
+    if (m && m->rows == rows && m->cols == cols) return m;
+    matrix_free(m);
+    return matrix_create(rows, cols);
+}
+
+static void add_filter_biases(const Conv1DShape* shape, const Matrix* biases, Matrix* z) {
+    // Pooling commutes with a per-filter constant, so the bias is added
+    // to the pooled outputs only
+    for (int f = 0; f < shape->filters; f++) {
+        double b = MATRIX_AT(biases, f, 0);
+        for (int p = 0; p < shape->pooled_length; p++) {
+            double* row = matrix_row(z, f * shape->pooled_length + p);
+            for (int j = 0; j < z->cols; j++) row[j] += b;
+        }
+    }
+}
+
+void conv1d_forward(Layer* layer, const Matrix* input, Matrix* z) {
+    const Conv1DShape* shape = &layer->conv;
+    int batch = input->cols;
+    layer->conv_out = ensure_shape(layer->conv_out, shape->filters, shape->conv_length * batch);
+
+    if (conv1d_uses_direct(shape)) {
+        matrix_free(layer->columns);
+        layer->columns = NULL;
+        conv1d_direct(shape, layer->weights, input, layer->conv_out);
+    } else {
+        layer->columns = ensure_shape(layer->columns, shape->channels * shape->kernel_size,
+                                      shape->conv_length * batch);
+        conv1d_im2col(shape, input, layer->columns);
+        matrix_gemm(layer->conv_out, layer->weights, 0, layer->columns, 0, 1.0, 0.0);
+    }
+
+    conv1d_pool(shape, layer->pooling, layer->conv_out, z);
+    add_filter_biases(shape, layer->biases, z);
+}
+
+void conv1d_infer(const Layer* layer, const Matrix* input, Matrix* z) {
+    const Conv1DShape* shape = &layer->conv;
+    int batch = input->cols;
+    Matrix* conv_out = matrix_create(shape->filters, shape->conv_length * batch);
+
+    if (conv1d_uses_direct(shape)) {
+        conv1d_direct(shape, layer->weights, input, conv_out);
+    } else {
+        Matrix* columns = matrix_create(shape->channels * shape->kernel_size, shape->conv_length * batch);
+        conv1d_im2col(shape, input, columns);
+        matrix_gemm(conv_out, layer->weights, 0, columns, 0, 1.0, 0.0);
+        matrix_free(columns);
+    }
+
+    conv1d_pool(shape, layer->pooling, conv_out, z);
+    add_filter_biases(shape, layer->biases, z);
+    matrix_free(conv_out);
+}
+
+// dW and the input gradient straight from the input, for small filters
+static void direct_backward(const Conv1DShape* shape, const Matrix* weights, const Matrix* input,
+                            const Matrix* conv_grad, double batch_scale, Matrix* dW, Matrix* input_grad) {
+    int batch = input->cols;
+    if (input_grad) matrix_fill(input_grad, 0.0);
+
+    for (int f = 0; f < shape->filters; f++) {
+        const double* g = matrix_row(conv_grad, f);
+        for (int c = 0; c < shape->channels; c++) {
+            for (int i = 0; i < shape->kernel_size; i++) {
+                int tap = c * shape->kernel_size + i;
+                double w = MATRIX_AT(weights, f, tap);
+                double sum = 0.0;
+                for (int t = 0; t < shape->conv_length; t++) {
+                    const double* x = matrix_row(input, c * shape->length + t + i);
+                    const double* gt = g + (size_t)t * batch;
+                    for (int j = 0; j < batch; j++) sum += gt[j] * x[j];
+
+                    if (input_grad) {
+                        double* dx = matrix_row(input_grad, c * shape->length + t + i);
+                        for (int j = 0; j < batch; j++) dx[j] += w * gt[j];
+                    }
+                }
+                MATRIX_AT(dW, f, tap) = sum * batch_scale;
+            }
+        }
+    }
+}
+
+void conv1d_backward(Layer* layer, double batch_scale, Matrix* input_grad) {
+    const Conv1DShape* shape = &layer->conv;
+    Matrix* conv_grad = matrix_create(layer->conv_out->rows, layer->conv_out->cols);
+    conv1d_unpool(shape, layer->pooling, layer->conv_out, layer->delta, conv_grad);
+
+    layer->dW = ensure_shape(layer->dW, layer->weights->rows, layer->weights->cols);
+    layer->db = ensure_shape(layer->db, shape->filters, 1);
+    for (int f = 0; f < shape->filters; f++) {
+        const double* g = matrix_row(conv_grad, f);
+        double sum = 0.0;
+        for (int j = 0; j < conv_grad->cols; j++) sum += g[j];
+        MATRIX_AT(layer->db, f, 0) = sum * batch_scale;
+    }
+
+    if (layer->columns == NULL) {
+        direct_backward(shape, layer->weights, layer->input, conv_grad, batch_scale, layer->dW, input_grad);
+    } else {
+        // dW = dconv * columns^T; the input gradient is col2im(W^T * dconv)
+        matrix_gemm(layer->dW, conv_grad, 0, layer->columns, 1, batch_scale, 0.0);
+        if (input_grad) {
+            Matrix* column_grad = matrix_create(layer->columns->rows, layer->columns->cols);
+            matrix_gemm(column_grad, layer->weights, 1, conv_grad, 0, 1.0, 0.0);
+            conv1d_col2im(shape, column_grad, input_grad);
+            matrix_free(column_grad);
+        }
+    }
+
+    matrix_free(conv_grad);
+}
+
+double conv1d_flops(const Conv1DShape* shape, int batch) {
+    return 2.0 * shape->channels * shape->kernel_size * shape->filters * shape->conv_length * batch;
+}
@@ -0,0 +1,51 @@
+#ifndef CONV1D_H
+#define CONV1D_H
+
+#include "neural_network.h"
+
+// 1D convolution on batches of B examples (one per column, laid out as in
+// Conv1DShape). The unpooled result conv_out is (filters x conv_length * B)
+// with position t of example j in column t * B + j, so im2col, col2im,
+// pooling and the direct kernels all copy or accumulate whole rows of B
+// contiguous values.
+//
+// Filters with channels * kernel_size taps up to this limit are applied
+// directly, which skips the column buffer (about 2.5x faster than im2col +
+// GEMM at 2 taps, on par at 6-8). Larger ones are lowered with im2col and
+// run through GEMM.
+#define CONV1D_DIRECT_MAX_TAPS 8
+
+// Fill in the derived sizes; returns 1 for an impossible geometry
+int conv1d_shape_init(Conv1DShape* shape, int channels, int length, int kernel_size,
+                      int filters, int pool_size);
+int conv1d_uses_direct(const Conv1DShape* shape);
+
+// columns (channels * kernel_size x conv_length * B): row c * kernel_size + i,
+// column t * B + j holds input(c * length + t + i, j)
+void conv1d_im2col(const Conv1DShape* shape, const Matrix* input, Matrix* columns);
+// Adjoint of im2col: input_grad (channels * length x B) is overwritten
+// with the sum of every column entry that read each input element
+void conv1d_col2im(const Conv1DShape* shape, const Matrix* columns, Matrix* input_grad);
+// conv_out = W * x without the bias, without forming the columns
+void conv1d_direct(const Conv1DShape* shape, const Matrix* weights, const Matrix* input, Matrix* conv_out);
+
+// pooled (filters * pooled_length x B) from conv_out, and the gradient
+// w.r.t. conv_out from the gradient w.r.t. pooled (the maximum of each
+// window takes all of it; dropped tail positions get zero)
+void conv1d_pool(const Conv1DShape* shape, PoolingType pooling, const Matrix* conv_out, Matrix* pooled);
+void conv1d_unpool(const Conv1DShape* shape, PoolingType pooling, const Matrix* conv_out,
+                   const Matrix* pooled_grad, Matrix* conv_grad);
+
+// Layer passes. conv1d_forward caches the columns and conv_out for the
+// backward pass and writes z = pool(W * x) + b; conv1d_infer does the
+// same with private scratch. conv1d_backward fills dW and db from the
+// layer's delta and, if input_grad is not NULL, writes the gradient
+// w.r.t. the layer input (before the previous activation's derivative).
+void conv1d_forward(Layer* layer, const Matrix* input, Matrix* z);
+void conv1d_infer(const Layer* layer, const Matrix* input, Matrix* z);
+void conv1d_backward(Layer* layer, double batch_scale, Matrix* input_grad);
+
+// FLOPs of the convolution for a batch (multiply-add = 2 FLOPs)
+double conv1d_flops(const Conv1DShape* shape, int batch);
+
+#endif
@@ -0,0 +1,271 @@
+#include "dataset_cache.h"
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+static int write_padding(FILE* file, uint64_t from, uint64_t to) {
+    static const char zeros[8] = {0};
+    return to > from ? fwrite(zeros, 1, to - from, file) == to - from : 1;
+}
+
+int dataset_cache_write(const char* path, const TrainingDataset* dataset,
+                        Matrix** inputs, Matrix** targets,
+                        const char* source_path, uint64_t feature_signature) {
+    int count = dataset->count;
+    if (count == 0) {
+        fprintf(stderr, "Error: Cannot cache an empty dataset\n");
+        return 1;
+    }
+
+    DatasetCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_CACHE_MAGIC, sizeof(header.magic));
+    header.version = DATASET_CACHE_VERSION;
+    header.input_size = inputs[0]->rows;
+    header.target_size = targets[0]->rows;
+    header.count = count;
+    header.feature_signature = feature_signature;
+
+    if (source_path) {
+        struct stat st;
+        if (stat(source_path, &st) == 0) {
+            header.source_size = st.st_size;
+            header.source_mtime = st.st_mtime;
+        }
+    }
+
+    uint64_t text_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        text_bytes += strlen(dataset->examples[i].text) + 1;
+    }
+
+    header.labels_offset = align8(sizeof(header));
+    header.features_offset = header.labels_offset + count * sizeof(double);
+    header.targets_offset = header.features_offset + (uint64_t)header.input_size * count * sizeof(double);
+    header.text_offsets_offset = header.targets_offset + (uint64_t)header.target_size * count * sizeof(double);
+    header.text_offset = header.text_offsets_offset + (count + 1) * sizeof(uint64_t);
+    header.file_size = header.text_offset + text_bytes;
+
+    // Write to a temporary file and rename, so readers never map a partial cache
+    size_t tmp_len = strlen(path) + 5;
+    char* tmp_path = (char*)malloc(tmp_len);
+    snprintf(tmp_path, tmp_len, "%s.tmp", path);
+
+    FILE* file = fopen(tmp_path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not create cache file '%s'\n", tmp_path);
+        free(tmp_path);
+        return 1;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && write_padding(file, sizeof(header), header.labels_offset);
+
+    for (int i = 0; ok && i < count; i++) {
+        ok = fwrite(&dataset->examples[i].label, sizeof(double), 1, file) == 1;
+    }
+
+    // Store feature-major so a batch of consecutive examples is one
+    // contiguous run per feature
+    for (uint32_t f = 0; ok && f < header.input_size; f++) {
+        for (int i = 0; ok && i < count; i++) {
+            ok = fwrite(matrix_row(inputs[i], f), sizeof(double), 1, file) == 1;
+        }
+    }
+    for (uint32_t f = 0; ok && f < header.target_size; f++) {
+        for (int i = 0; ok && i < count; i++) {
+            ok = fwrite(matrix_row(targets[i], f), sizeof(double), 1, file) == 1;
+        }
+    }
+
+    uint64_t offset = 0;
+    for (int i = 0; ok && i <= count; i++) {
+        ok = fwrite(&offset, sizeof(offset), 1, file) == 1;
+        if (i < count) offset += strlen(dataset->examples[i].text) + 1;
+    }
+    for (int i = 0; ok && i < count; i++) {
+        const char* text = dataset->examples[i].text;
+        ok = fwrite(text, 1, strlen(text) + 1, file) == strlen(text) + 1;
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    if (ok && rename(tmp_path, path) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write cache file '%s'\n", path);
+        remove(tmp_path);
+    }
+
+    free(tmp_path);
+    return ok ? 0 : 1;
+}
+
+// Advance *offset past a section of count elements of elem_size bytes.
+// Returns 0 if the section would run past limit (or overflow).
+static int skip_section(uint64_t* offset, uint64_t count, uint64_t elem_size, uint64_t limit) {
+    if (*offset > limit) return 0;
+    if (elem_size != 0 && count > (limit - *offset) / elem_size) return 0;
+    *offset += count * elem_size;
+    return 1;
+}
+
+// Recompute the layout dataset_cache_write produces from count and the
+// vector sizes, and require the header offsets to match it exactly. The
+// text offsets must start at 0, be strictly increasing, end at the end of
+// the file, and each string must be NUL-terminated within its range.
+static int check_layout(const char* base, const DatasetCacheHeader* header) {
+    uint64_t limit = header->file_size;
+    uint64_t offset = align8(sizeof(*header));
+    if (header->labels_offset != offset ||
+        !skip_section(&offset, header->count, sizeof(double), limit) ||
+        header->features_offset != offset ||
+        !skip_section(&offset, header->count, (uint64_t)header->input_size * sizeof(double), limit) ||
+        header->targets_offset != offset ||
+        !skip_section(&offset, header->count, (uint64_t)header->target_size * sizeof(double), limit) ||
+        header->text_offsets_offset != offset ||
+        !skip_section(&offset, header->count + 1, sizeof(uint64_t), limit) ||
+        header->text_offset != offset) {
+        return 0;
+    }
+
+    const uint64_t* text_offsets = (const uint64_t*)(base + header->text_offsets_offset);
+    const char* text = base + header->text_offset;
+    uint64_t text_bytes = limit - header->text_offset;
+    if (text_offsets[0] != 0 || text_offsets[header->count] != text_bytes) return 0;
+    for (uint64_t i = 0; i < header->count; i++) {
+        uint64_t end = text_offsets[i + 1];
+        if (end <= text_offsets[i] || end > text_bytes || text[end - 1] != '\0') return 0;
+    }
+    return 1;
+}
+
+DatasetCache* dataset_cache_open(const char* path, const char* source_path,
+                                 uint64_t feature_signature) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(DatasetCacheHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const DatasetCacheHeader* header = (const DatasetCacheHeader*)map;
+    int valid = memcmp(header->magic, DATASET_CACHE_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == DATASET_CACHE_VERSION &&
+                header->file_size == (uint64_t)st.st_size &&
+                header->feature_signature == feature_signature &&
+                header->count > 0 && header->count <= 0x7FFFFFFF;
+
+    if (valid && source_path) {
+        struct stat source;
+        valid = stat(source_path, &source) == 0 &&
+                header->source_size == (uint64_t)source.st_size &&
+                header->source_mtime == (int64_t)source.st_mtime;
+    }
+
+    if (!valid) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    if (!check_layout((const char*)map, header)) {
+        fprintf(stderr, "Error: Corrupt cache file '%s'\n", path);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    // Training reads examples in order
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    const char* base = (const char*)map;
+    DatasetCache* cache = (DatasetCache*)malloc(sizeof(DatasetCache));
+    cache->map = map;
+    cache->map_size = st.st_size;
+    cache->count = (int)header->count;
+    cache->input_size = header->input_size;
+    cache->target_size = header->target_size;
+    cache->labels = (const double*)(base + header->labels_offset);
+    cache->features = (const double*)(base + header->features_offset);
+    cache->targets = (const double*)(base + header->targets_offset);
+    cache->text_offsets = (const uint64_t*)(base + header->text_offsets_offset);
+    cache->text = base + header->text_offset;
+    return cache;
+}
+
+void dataset_cache_close(DatasetCache* cache) {
+    if (cache == NULL) return;
+    munmap(cache->map, cache->map_size);
+    free(cache);
+}
+
+const char* dataset_cache_text(const DatasetCache* cache, int index) {
+    return cache->text + cache->text_offsets[index];
+}
+
+double dataset_cache_label(const DatasetCache* cache, int index) {
+    return cache->labels[index];
+}
+
+void dataset_cache_load_batch(const DatasetCache* cache, int start, int count,
+                              Matrix* inputs, Matrix* targets) {
+    for (int f = 0; f < cache->input_size; f++) {
+        memcpy(matrix_row(inputs, f), cache->features + (size_t)f * cache->count + start,
+               count * sizeof(double));
+    }
+    if (targets) {
+        for (int f = 0; f < cache->target_size; f++) {
+            memcpy(matrix_row(targets, f), cache->targets + (size_t)f * cache->count + start,
+                   count * sizeof(double));
+        }
+    }
+}
+
+void dataset_cache_view_batch(const DatasetCache* cache, int start, int count,
+                              Matrix* inputs, Matrix* targets) {
+    Matrix features = { cache->input_size, cache->count, cache->count, (double*)cache->features, 0 };
+    *inputs = matrix_slice_cols(&features, start, count);
+    if (targets) {
+        Matrix all_targets = { cache->target_size, cache->count, cache->count, (double*)cache->targets, 0 };
+        *targets = matrix_slice_cols(&all_targets, start, count);
+    }
+}
+
+void dataset_cache_fetch(void* source, int index, double* input, double* target) {
+    const DatasetCache* cache = (const DatasetCache*)source;
+    for (int f = 0; f < cache->input_size; f++) {
+        input[f] = cache->features[(size_t)f * cache->count + index];
+    }
+    for (int f = 0; f < cache->target_size; f++) {
+        target[f] = cache->targets[(size_t)f * cache->count + index];
+    }
+}
+
+void nn_train_cached(NeuralNetwork* nn, const DatasetCache* cache, int epochs) {
+    Matrix input, target;
+
+    int first_epoch = nn->checkpointer ? checkpointer_start_epoch(nn->checkpointer) : 0;
+    for (int epoch = first_epoch; epoch < epochs; epoch++) {
+        double total_loss = 0.0;
+        if (nn->profiler) profiler_begin_epoch(nn->profiler);
+
+        for (int i = 0; i < cache->count; i++) {
+            dataset_cache_view_batch(cache, i, 1, &input, &target);
+            total_loss += nn_train_sample(nn, &input, &target);
+        }
+
+        if (nn_end_epoch(nn, epoch, epochs, cache->count, total_loss / cache->count)) break;
+    }
+}
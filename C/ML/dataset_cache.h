@@ -0,0 +1,88 @@
+#ifndef DATASET_CACHE_H
+#define DATASET_CACHE_H
+
+#include <stdint.h>
+#include "neural_network.h"
+#include "json_parser.h"
+
+// Binary, columnar snapshot of a featurized TrainingDataset. The file is
+// written once and then memory-mapped, so later runs skip JSON parsing and
+// featurization entirely.
+//
+// Layout (host byte order, every section 8-byte aligned):
+//   DatasetCacheHeader
+//   double   labels[count]
+//   double   features[input_size][count]   one column of N values per feature
+//   double   targets[target_size][count]
+//   uint64_t text_offsets[count + 1]
+//   char     text[]                        NUL-terminated strings
+#define DATASET_CACHE_MAGIC "AUDSET\0\0"
+#define DATASET_CACHE_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t input_size;
+    uint32_t target_size;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t feature_signature;  // Caller-defined hash of the featurizer
+    uint64_t source_size;        // Size and mtime of the source file,
+    int64_t source_mtime;        // used to detect a stale cache
+    uint64_t labels_offset;
+    uint64_t features_offset;
+    uint64_t targets_offset;
+    uint64_t text_offsets_offset;
+    uint64_t text_offset;
+    uint64_t file_size;
+} DatasetCacheHeader;
+
+typedef struct {
+    void* map;
+    size_t map_size;
+    int count;
+    int input_size;
+    int target_size;
+    const double* labels;
+    const double* features;
+    const double* targets;
+    const uint64_t* text_offsets;
+    const char* text;
+} DatasetCache;
+
+// Write the dataset and its per-example feature/target column vectors.
+// source_path may be NULL to skip the staleness check on open.
+// Returns 0 on success.
+int dataset_cache_write(const char* path, const TrainingDataset* dataset,
+                        Matrix** inputs, Matrix** targets,
+                        const char* source_path, uint64_t feature_signature);
+
+// Map a cache file. Returns NULL if it is missing, corrupt, older than
+// source_path or was built with a different feature_signature.
+DatasetCache* dataset_cache_open(const char* path, const char* source_path,
+                                 uint64_t feature_signature);
+void dataset_cache_close(DatasetCache* cache);
+
+// Accessors (no copies; valid until the cache is closed)
+const char* dataset_cache_text(const DatasetCache* cache, int index);
+double dataset_cache_label(const DatasetCache* cache, int index);
+
+// Copy examples [start, start + count) into column matrices of shape
+// (input_size x count) and (target_size x count); targets may be NULL
+void dataset_cache_load_batch(const DatasetCache* cache, int start, int count,
+                              Matrix* inputs, Matrix* targets);
+
+// Zero-copy alternative: point inputs/targets (caller-owned headers, not
+// passed to matrix_free) at examples [start, start + count) inside the
+// mapping. The features are stored feature-major, so a run of consecutive
+// examples is a column slice. The views are read-only.
+void dataset_cache_view_batch(const DatasetCache* cache, int start, int count,
+                              Matrix* inputs, Matrix* targets);
+
+// Fetch callback for pipeline_create(): copies one example from the mapping
+void dataset_cache_fetch(void* cache, int index, double* input, double* target);
+
+// Train directly from the mapped file, one example at a time
+void nn_train_cached(NeuralNetwork* nn, const DatasetCache* cache, int epochs);
+
+#endif
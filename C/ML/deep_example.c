@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "neural_network.h"
+
+#define NUM_INPUTS 32
+#define WIDTH 128
+#define HIDDEN_LAYERS 30
+#define NUM_SAMPLES 1024
+#define BATCH_SIZE 256
+#define EPOCHS 2
+
+// Smooth nonlinear target of the inputs in each column
+void generate_data(Matrix* inputs, Matrix* targets) {
+    matrix_randomize_seeded(inputs, -1.0, 1.0, 2024, 0);
+    for (int j = 0; j < inputs->cols; j++) {
+        double sum = 0.0;
+        for (int i = 0; i < inputs->rows; i++) {
+            sum += MATRIX_AT(inputs, i, j) * (i % 2 ? 1.0 : -0.5);
+        }
+        MATRIX_AT(targets, 0, j) = sin(sum / sqrt((double)inputs->rows));
+    }
+}
+
+NeuralNetwork* create_deep_network(void) {
+    int num_layers = HIDDEN_LAYERS + 1;
+    NeuralNetwork* nn = nn_create(num_layers);
+    nn_add_layer(nn, 0, NUM_INPUTS, WIDTH, ACTIVATION_TANH);
+    for (int i = 1; i < HIDDEN_LAYERS; i++) {
+        nn_add_layer(nn, i, WIDTH, WIDTH, ACTIVATION_TANH);
+    }
+    nn_add_layer(nn, HIDDEN_LAYERS, WIDTH, 1, ACTIVATION_LINEAR);
+    nn_set_seed(nn, 42);
+    nn->learning_rate = 0.01;
+    return nn;
+}
+
+int main() {
+    printf("=== Gradient Checkpointing Example ===\n\n");
+    printf("%d -> %d x %d -> 1 tanh network (%d layers), %d samples in batches of %d, %d epochs\n\n",
+           NUM_INPUTS, HIDDEN_LAYERS, WIDTH, HIDDEN_LAYERS + 1, NUM_SAMPLES, BATCH_SIZE, EPOCHS);
+
+    Matrix* inputs = matrix_create(NUM_INPUTS, NUM_SAMPLES);
+    Matrix* targets = matrix_create(1, NUM_SAMPLES);
+    generate_data(inputs, targets);
+
+    int num_batches = NUM_SAMPLES / BATCH_SIZE;
+    Matrix** input_batches = (Matrix**)malloc(num_batches * sizeof(Matrix*));
+    Matrix** target_batches = (Matrix**)malloc(num_batches * sizeof(Matrix*));
+    for (int b = 0; b < num_batches; b++) {
+        input_batches[b] = (Matrix*)malloc(sizeof(Matrix));
+        target_batches[b] = (Matrix*)malloc(sizeof(Matrix));
+        *input_batches[b] = matrix_slice_cols(inputs, b * BATCH_SIZE, BATCH_SIZE);
+        *target_batches[b] = matrix_slice_cols(targets, b * BATCH_SIZE, BATCH_SIZE);
+    }
+
+    // Interval 0 keeps every layer's activations; k keeps the input of
+    // every k-th layer and recomputes the rest during backpropagation.
+    // About sqrt(layers) minimizes the memory.
+    static const int intervals[] = { 0, 2, 4, 6, 10 };
+    int num_intervals = sizeof(intervals) / sizeof(intervals[0]);
+
+    printf("%8s %12s %10s %10s %12s %10s %12s\n", "interval", "peak act MB", "vs all", "seconds",
+           "overhead", "recomputed", "final loss");
+    double baseline_bytes = 0.0, baseline_loss = 0.0;
+    int identical = 1;
+    for (int v = 0; v < num_intervals; v++) {
+        NeuralNetwork* nn = create_deep_network();
+        nn->recompute_interval = intervals[v];
+
+        double start = profiler_now();
+        double loss = 0.0;
+        for (int epoch = 0; epoch < EPOCHS; epoch++) {
+            loss = 0.0;
+            for (int b = 0; b < num_batches; b++) {
+                loss += nn_train_sample(nn, input_batches[b], target_batches[b]);
+            }
+            loss /= num_batches;
+        }
+        double seconds = profiler_now() - start;
+
+        ActivationStats* stats = &nn->activation_stats;
+        double bytes = (double)stats->peak_activation_bytes;
+        if (v == 0) {
+            baseline_bytes = bytes;
+            baseline_loss = loss;
+        }
+        if (loss != baseline_loss) identical = 0;
+        // Reruns per regular layer forward, and the time they took
+        // relative to the rest of training
+        double recomputed = (double)stats->recomputed_layers / stats->forward_layers;
+        double overhead = stats->recompute_seconds / (seconds - stats->recompute_seconds);
+        printf("%8d %12.2f %9.2fx %10.3f %11.1f%% %9.0f%% %12.8f\n", intervals[v], bytes / (1 << 20),
+               baseline_bytes / bytes, seconds, overhead * 100, recomputed * 100, loss);
+        nn_free(nn);
+    }
+
+    printf("\nRecomputation reproduces the same arithmetic, so the losses %s.\n",
+           identical ? "match exactly" : "DIFFER (unexpected)");
+    printf("Peak activation memory falls from O(layers) to O(layers / k + k) batches of\n");
+    printf("activations, for about one extra forward pass per step.\n\n");
+
+    for (int b = 0; b < num_batches; b++) {
+        free(input_batches[b]);
+        free(target_batches[b]);
+    }
+    free(input_batches);
+    free(target_batches);
+    matrix_free(inputs);
+    matrix_free(targets);
+    return 0;
+}
@@ -0,0 +1,453 @@
+#include "distributed.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+// Coordinator poll interval while waiting for workers to register
+#define REGISTER_POLL_MS 100
+
+static int send_all(int fd, const void* data, size_t bytes) {
+    const char* p = (const char*)data;
+    while (bytes > 0) {
+        ssize_t n = send(fd, p, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 1;
+        p += n;
+        bytes -= n;
+    }
+    return 0;
+}
+
+static int recv_all(int fd, void* data, size_t bytes) {
+    char* p = (char*)data;
+    while (bytes > 0) {
+        ssize_t n = recv(fd, p, bytes, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 1;
+        p += n;
+        bytes -= n;
+    }
+    return 0;
+}
+
+// Send and receive at the same time. Every worker sends to its right
+// neighbour while receiving from its left one, so a blocking send of a
+// chunk larger than the socket buffer would deadlock the ring.
+static int exchange(int send_fd, const void* send_data, size_t send_bytes,
+                    int recv_fd, void* recv_data, size_t recv_bytes) {
+    const char* out = (const char*)send_data;
+    char* in = (char*)recv_data;
+
+    while (send_bytes > 0 || recv_bytes > 0) {
+        struct pollfd fds[2];
+        int count = 0;
+        int send_slot = -1;
+        int recv_slot = -1;
+        if (send_bytes > 0) {
+            fds[count].fd = send_fd;
+            fds[count].events = POLLOUT;
+            send_slot = count++;
+        }
+        if (recv_bytes > 0) {
+            fds[count].fd = recv_fd;
+            fds[count].events = POLLIN;
+            recv_slot = count++;
+        }
+
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+
+        if (send_slot >= 0 && fds[send_slot].revents) {
+            ssize_t n = send(send_fd, out, send_bytes, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return 1;
+            if (n > 0) {
+                out += n;
+                send_bytes -= n;
+            }
+        }
+        if (recv_slot >= 0 && fds[recv_slot].revents) {
+            ssize_t n = recv(recv_fd, in, recv_bytes, MSG_DONTWAIT);
+            if (n == 0) return 1;  // Peer closed
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return 1;
+            if (n > 0) {
+                in += n;
+                recv_bytes -= n;
+            }
+        }
+    }
+    return 0;
+}
+
+// Listening socket on 127.0.0.1; *port is updated with the bound port
+static int listen_on(int* port, int backlog) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(*port);
+    socklen_t length = sizeof(addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, backlog) < 0 ||
+        getsockname(fd, (struct sockaddr*)&addr, &length) < 0) {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static void set_nodelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+static int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    set_nodelay(fd);
+    return fd;
+}
+
+// Chunk c of the ring covers values[chunk_start(c) .. chunk_start(c + 1))
+static int chunk_start(int c, int count, int num_workers) {
+    return (int)((long)c * count / num_workers);
+}
+
+int ring_allreduce(double* values, int count, int rank, int num_workers, int left_fd, int right_fd) {
+    if (num_workers == 1) return 0;
+
+    int max_chunk = count / num_workers + 1;
+    double* incoming = (double*)malloc(max_chunk * sizeof(double));
+    int status = 0;
+
+    // Reduce-scatter: after N - 1 steps worker r holds the full sum of
+    // chunk r + 1. Each step sends one chunk right and adds the one
+    // arriving from the left.
+    for (int step = 0; step < num_workers - 1 && status == 0; step++) {
+        int send_chunk = ((rank - step) % num_workers + num_workers) % num_workers;
+        int recv_chunk = ((rank - step - 1) % num_workers + num_workers) % num_workers;
+        int send_begin = chunk_start(send_chunk, count, num_workers);
+        int send_count = chunk_start(send_chunk + 1, count, num_workers) - send_begin;
+        int recv_begin = chunk_start(recv_chunk, count, num_workers);
+        int recv_count = chunk_start(recv_chunk + 1, count, num_workers) - recv_begin;
+
+        status = exchange(right_fd, values + send_begin, send_count * sizeof(double),
+                          left_fd, incoming, recv_count * sizeof(double));
+        for (int i = 0; i < recv_count && status == 0; i++) values[recv_begin + i] += incoming[i];
+    }
+
+    // Allgather: pass the completed chunks around the ring
+    for (int step = 0; step < num_workers - 1 && status == 0; step++) {
+        int send_chunk = ((rank + 1 - step) % num_workers + num_workers) % num_workers;
+        int recv_chunk = ((rank - step) % num_workers + num_workers) % num_workers;
+        int send_begin = chunk_start(send_chunk, count, num_workers);
+        int send_count = chunk_start(send_chunk + 1, count, num_workers) - send_begin;
+        int recv_begin = chunk_start(recv_chunk, count, num_workers);
+        int recv_count = chunk_start(recv_chunk + 1, count, num_workers) - recv_begin;
+
+        status = exchange(right_fd, values + send_begin, send_count * sizeof(double),
+                          left_fd, values + recv_begin, recv_count * sizeof(double));
+    }
+
+    free(incoming);
+    return status;
+}
+
+static int parameter_count(const NeuralNetwork* nn) {
+    int count = 0;
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        count += layer->output_size * (layer->input_size + 1);
+    }
+    return count;
+}
+
+// Copy weights and biases (or their gradients) of every layer to or from
+// one flat buffer, layer by layer, weights before biases
+static void flatten(NeuralNetwork* nn, double* buffer, int gradients, int unpack) {
+    for (int l = 0; l < nn->num_layers; l++) {
+        Layer* layer = nn->layers[l];
+        Matrix* w = gradients ? layer->dW : layer->weights;
+        Matrix* b = gradients ? layer->db : layer->biases;
+        for (int i = 0; i < w->rows; i++) {
+            if (unpack) memcpy(matrix_row(w, i), buffer, w->cols * sizeof(double));
+            else memcpy(buffer, matrix_row(w, i), w->cols * sizeof(double));
+            buffer += w->cols;
+        }
+        for (int i = 0; i < b->rows; i++) {
+            if (unpack) MATRIX_AT(b, i, 0) = buffer[i];
+            else buffer[i] = MATRIX_AT(b, i, 0);
+        }
+        buffer += b->rows;
+    }
+}
+
+static int worker_run(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples,
+                      int epochs, const DistributedConfig* config, int rank, int coordinator_port) {
+    int num_workers = config->num_workers;
+    int coordinator = connect_to(coordinator_port);
+    int listen_port = 0;
+    int listener = listen_on(&listen_port, 1);
+    if (coordinator < 0 || listener < 0) {
+        fprintf(stderr, "Worker %d: could not reach the coordinator\n", rank);
+        return 1;
+    }
+
+    // Register, then learn every worker's ring port
+    int hello[2] = { rank, listen_port };
+    int* ports = (int*)malloc(num_workers * sizeof(int));
+    if (send_all(coordinator, hello, sizeof(hello)) ||
+        recv_all(coordinator, ports, num_workers * sizeof(int))) {
+        fprintf(stderr, "Worker %d: registration failed\n", rank);
+        free(ports);
+        return 1;
+    }
+
+    // Connect to the right neighbour, accept the left one
+    int right_fd = -1;
+    int left_fd = -1;
+    if (num_workers > 1) {
+        right_fd = connect_to(ports[(rank + 1) % num_workers]);
+        left_fd = accept(listener, NULL, NULL);
+        if (right_fd < 0 || left_fd < 0) {
+            fprintf(stderr, "Worker %d: could not join the ring\n", rank);
+            free(ports);
+            return 1;
+        }
+        set_nodelay(left_fd);
+    }
+    close(listener);
+    free(ports);
+
+    // Every worker starts from the coordinator's weights (inherited by
+    // fork) and applies identical updates, so the replicas stay in sync
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        if (layer->dW == NULL) layer->dW = matrix_create(layer->output_size, layer->input_size);
+        if (layer->db == NULL) layer->db = matrix_create(layer->output_size, 1);
+    }
+
+    // Gradients, then the loss and the number of examples behind them
+    int num_params = parameter_count(nn);
+    int count = num_params + 2;
+    double* buffer = (double*)malloc(count * sizeof(double));
+    int steps_per_epoch = (num_samples + num_workers - 1) / num_workers;
+    DistributedStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.num_workers = num_workers;
+
+    int status = 0;
+    double start = profiler_now();
+    for (int epoch = 0; epoch < epochs && status == 0; epoch++) {
+        double total_loss = 0.0;
+        double total_examples = 0.0;
+
+        for (int step = 0; step < steps_per_epoch && status == 0; step++) {
+            int sample = step * num_workers + rank;
+            if (sample < num_samples) {
+                double examples = inputs[sample]->cols;
+                double loss = nn_compute_gradients(nn, inputs[sample], targets[sample]);
+                flatten(nn, buffer, 1, 0);
+                // Weight by batch size so the sum is over examples
+                for (int i = 0; i < num_params; i++) buffer[i] *= examples;
+                buffer[num_params] = loss * examples;
+                buffer[num_params + 1] = examples;
+            } else {
+                memset(buffer, 0, count * sizeof(double));  // Past the end of the data
+            }
+
+            double exchange_start = profiler_now();
+            status = ring_allreduce(buffer, count, rank, num_workers, left_fd, right_fd);
+            stats.allreduce_seconds += profiler_now() - exchange_start;
+            if (status) break;
+
+            double examples = buffer[num_params + 1];
+            for (int i = 0; i < num_params; i++) buffer[i] /= examples;
+            flatten(nn, buffer, 1, 1);
+            nn_update_weights(nn);
+
+            total_loss += buffer[num_params];
+            total_examples += examples;
+        }
+
+        stats.final_loss = total_loss / total_examples;
+        if (rank == 0 && config->verbose) nn_report_epoch(epoch, epochs, stats.final_loss);
+    }
+    stats.seconds = profiler_now() - start;
+    stats.samples_per_second = stats.seconds > 0.0 ? (double)num_samples * epochs / stats.seconds : 0.0;
+    stats.bytes_sent = 2.0 * (num_workers - 1) / num_workers * count * sizeof(double) *
+                       steps_per_epoch * epochs;
+
+    if (status) {
+        fprintf(stderr, "Worker %d: gradient exchange failed\n", rank);
+    } else if (rank == 0) {
+        // Report back and hand over the trained weights
+        flatten(nn, buffer, 0, 0);
+        status = send_all(coordinator, &stats, sizeof(stats)) ||
+                 send_all(coordinator, buffer, num_params * sizeof(double));
+    }
+
+    free(buffer);
+    if (left_fd >= 0) close(left_fd);
+    if (right_fd >= 0) close(right_fd);
+    close(coordinator);
+    return status;
+}
+
+static void stop_workers(pid_t* pids, int num_workers) {
+    for (int i = 0; i < num_workers; i++) {
+        if (pids[i] > 0) kill(pids[i], SIGTERM);
+    }
+    for (int i = 0; i < num_workers; i++) {
+        if (pids[i] > 0) waitpid(pids[i], NULL, 0);
+    }
+}
+
+// Wait for a connection, giving up if a worker exits first
+static int accept_worker(int listener, pid_t* pids, int num_workers) {
+    for (;;) {
+        struct pollfd fd = { listener, POLLIN, 0 };
+        int ready = poll(&fd, 1, REGISTER_POLL_MS);
+        if (ready > 0) return accept(listener, NULL, NULL);
+        if (ready < 0 && errno != EINTR) return -1;
+
+        for (int i = 0; i < num_workers; i++) {
+            if (pids[i] > 0 && waitpid(pids[i], NULL, WNOHANG) == pids[i]) {
+                pids[i] = 0;
+                return -1;
+            }
+        }
+    }
+}
+
+int nn_train_distributed(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples,
+                         int epochs, const DistributedConfig* config, DistributedStats* stats) {
+    int num_workers = config->num_workers;
+    if (num_workers < 1) {
+        fprintf(stderr, "Error: Distributed training needs at least one worker\n");
+        return 1;
+    }
+    for (int i = 0; i < nn->num_layers; i++) {
+        if (nn->layers[i]->type != LAYER_DENSE) {
+            fprintf(stderr, "Error: Distributed training supports dense layers only (layer %d)\n", i);
+            return 1;
+        }
+    }
+
+    int port = config->port;
+    int listener = listen_on(&port, num_workers);
+    if (listener < 0) {
+        fprintf(stderr, "Error: Coordinator cannot listen on port %d\n", config->port);
+        return 1;
+    }
+
+    // Output buffered before fork() would otherwise be printed once per worker
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t* pids = (pid_t*)calloc(num_workers, sizeof(pid_t));
+    for (int rank = 0; rank < num_workers; rank++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            nn->profiler = NULL;  // Belongs to the coordinator
+            int status = worker_run(nn, inputs, targets, num_samples, epochs, config, rank, port);
+            fflush(stdout);
+            _exit(status);
+        }
+        if (pid < 0) {
+            fprintf(stderr, "Error: Could not start worker %d\n", rank);
+            stop_workers(pids, num_workers);
+            free(pids);
+            close(listener);
+            return 1;
+        }
+        pids[rank] = pid;
+    }
+
+    // Start-up: collect each worker's ring port, then send out the table
+    int* connections = (int*)malloc(num_workers * sizeof(int));
+    int* ports = (int*)malloc(num_workers * sizeof(int));
+    for (int i = 0; i < num_workers; i++) connections[i] = -1;
+
+    int status = 0;
+    for (int i = 0; i < num_workers && status == 0; i++) {
+        int fd = accept_worker(listener, pids, num_workers);
+        int hello[2];
+        if (fd < 0 || recv_all(fd, hello, sizeof(hello)) || hello[0] < 0 || hello[0] >= num_workers) {
+            if (fd >= 0) close(fd);
+            status = 1;
+            break;
+        }
+        connections[hello[0]] = fd;
+        ports[hello[0]] = hello[1];
+    }
+    for (int i = 0; i < num_workers && status == 0; i++) {
+        status = send_all(connections[i], ports, num_workers * sizeof(int));
+    }
+
+    // Worker 0 reports the statistics and the final weights
+    if (status == 0) {
+        DistributedStats result;
+        double* weights = (double*)malloc(parameter_count(nn) * sizeof(double));
+        status = recv_all(connections[0], &result, sizeof(result)) ||
+                 recv_all(connections[0], weights, parameter_count(nn) * sizeof(double));
+        if (status == 0) {
+            flatten(nn, weights, 0, 1);
+            if (stats) *stats = result;
+        }
+        free(weights);
+    }
+
+    if (status) {
+        fprintf(stderr, "Error: Distributed training failed\n");
+        stop_workers(pids, num_workers);
+    } else {
+        for (int i = 0; i < num_workers; i++) {
+            int exit_status = 0;
+            waitpid(pids[i], &exit_status, 0);
+            if (!WIFEXITED(exit_status) || WEXITSTATUS(exit_status) != 0) status = 1;
+        }
+    }
+
+    for (int i = 0; i < num_workers; i++) {
+        if (connections[i] >= 0) close(connections[i]);
+    }
+    free(connections);
+    free(ports);
+    free(pids);
+    close(listener);
+    return status;
+}
+
+double distributed_scaling_efficiency(const DistributedStats* single, const DistributedStats* parallel) {
+    if (single->samples_per_second <= 0.0 || parallel->num_workers < 1) return 0.0;
+    return parallel->samples_per_second / (single->samples_per_second * parallel->num_workers);
+}
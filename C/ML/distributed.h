@@ -0,0 +1,40 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include "neural_network.h"
+
+// Data-parallel training across processes on one host. The calling
+// process is the coordinator: it forks num_workers workers, hands out the
+// ring addresses at start-up and collects the trained weights at the end.
+// Worker r trains on samples r, r + N, r + 2N, ... in lockstep; after each
+// step the gradients are summed with a ring-allreduce over TCP on
+// 127.0.0.1 so every worker applies the same averaged update. One step
+// therefore averages N samples (or batches), like a batch N times larger.
+typedef struct {
+    int num_workers;
+    int port;        // Coordinator port on 127.0.0.1; 0 picks a free one
+    int verbose;     // Print the per-epoch loss (from worker 0)
+} DistributedConfig;
+
+typedef struct {
+    int num_workers;
+    double seconds;              // Training wall time of worker 0
+    double allreduce_seconds;    // Of which spent exchanging gradients
+    double samples_per_second;
+    double bytes_sent;           // Per worker, over all steps
+    double final_loss;           // Average loss of the last epoch
+} DistributedStats;
+
+// Train `nn` in place (dense layers only). stats may be NULL. Returns 1
+// if the network is unsupported or a worker fails.
+int nn_train_distributed(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples,
+                         int epochs, const DistributedConfig* config, DistributedStats* stats);
+
+// Sum `count` doubles element-wise across the ring; every worker ends up
+// with the total. left_fd receives from rank - 1, right_fd sends to rank + 1.
+int ring_allreduce(double* values, int count, int rank, int num_workers, int left_fd, int right_fd);
+
+// Throughput of `parallel` relative to num_workers times `single`
+double distributed_scaling_efficiency(const DistributedStats* single, const DistributedStats* parallel);
+
+#endif
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "neural_network.h"
+#include "distributed.h"
+
+#define INPUT_SIZE 16
+#define HIDDEN_SIZE 128
+#define OUTPUT_SIZE 4
+#define BATCH_SIZE 32
+#define NUM_BATCHES 64
+#define EPOCHS 20
+#define SEED 1234
+
+// Targets are fixed smooth functions of the inputs
+void generate_batches(Matrix** inputs, Matrix** targets) {
+    for (int b = 0; b < NUM_BATCHES; b++) {
+        inputs[b] = matrix_create(INPUT_SIZE, BATCH_SIZE);
+        targets[b] = matrix_create(OUTPUT_SIZE, BATCH_SIZE);
+        matrix_randomize_seeded(inputs[b], -1.0, 1.0, SEED, b);
+
+        for (int j = 0; j < BATCH_SIZE; j++) {
+            for (int k = 0; k < OUTPUT_SIZE; k++) {
+                double sum = 0.0;
+                for (int i = k; i < INPUT_SIZE; i += OUTPUT_SIZE) sum += MATRIX_AT(inputs[b], i, j);
+                MATRIX_AT(targets[b], k, j) = sin(sum);
+            }
+        }
+    }
+}
+
+NeuralNetwork* create_network(void) {
+    NeuralNetwork* nn = nn_create(3);
+    nn_set_seed(nn, SEED);
+    nn_add_layer(nn, 0, INPUT_SIZE, HIDDEN_SIZE, ACTIVATION_TANH);
+    nn_add_layer(nn, 1, HIDDEN_SIZE, HIDDEN_SIZE, ACTIVATION_TANH);
+    nn_add_layer(nn, 2, HIDDEN_SIZE, OUTPUT_SIZE, ACTIVATION_LINEAR);
+    nn->learning_rate = 0.05;
+    return nn;
+}
+
+int main(int argc, char** argv) {
+    int max_workers = argc > 1 ? atoi(argv[1]) : 4;
+
+    printf("=== Distributed Training Example ===\n\n");
+    printf("Architecture: %d -> %d -> %d -> %d, %d batches of %d, %d epochs\n",
+           INPUT_SIZE, HIDDEN_SIZE, HIDDEN_SIZE, OUTPUT_SIZE, NUM_BATCHES, BATCH_SIZE, EPOCHS);
+    printf("Workers exchange gradients by ring-allreduce over TCP on 127.0.0.1\n\n");
+
+    Matrix* inputs[NUM_BATCHES];
+    Matrix* targets[NUM_BATCHES];
+    generate_batches(inputs, targets);
+
+    printf("workers   seconds   samples/s   allreduce   MB sent/worker   final loss   efficiency\n");
+    DistributedStats single;
+    for (int workers = 1; workers <= max_workers; workers *= 2) {
+        NeuralNetwork* nn = create_network();
+        DistributedConfig config = { workers, 0, 0 };
+        DistributedStats stats;
+        if (nn_train_distributed(nn, inputs, targets, NUM_BATCHES, EPOCHS, &config, &stats)) {
+            nn_free(nn);
+            break;
+        }
+        if (workers == 1) single = stats;
+
+        // Samples are counted as examples, not batches
+        printf("%7d %9.3f %11.0f %10.1f%% %16.2f %12.6f %11.1f%%\n", workers, stats.seconds,
+               stats.samples_per_second * BATCH_SIZE, 100.0 * stats.allreduce_seconds / stats.seconds,
+               stats.bytes_sent / 1e6, stats.final_loss,
+               100.0 * distributed_scaling_efficiency(&single, &stats));
+        nn_free(nn);
+    }
+
+    printf("\nEach step averages one batch per worker, so more workers take fewer,\n");
+    printf("larger steps per epoch. Efficiency is throughput relative to the\n");
+    printf("number of workers times a single process.\n");
+
+    for (int b = 0; b < NUM_BATCHES; b++) {
+        matrix_free(inputs[b]);
+        matrix_free(targets[b]);
+    }
+    return 0;
+}
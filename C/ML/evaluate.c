@@ -0,0 +1,238 @@
+#include "evaluate.h"
+#include <pthread.h>
+#include <unistd.h>
+
+#define EVAL_DEFAULT_BATCH 64
+#define EVAL_MAX_THREADS 64
+
+typedef struct {
+    const NeuralNetwork* nn;
+    const Matrix* inputs;
+    const Matrix* targets;
+    int first;        // Columns [first, last)
+    int last;
+    int batch_size;
+    double loss_sum;  // Summed per example
+    int correct;
+} EvalTask;
+
+static int argmax_column(const Matrix* m, int j) {
+    int best = 0;
+    for (int i = 1; i < m->rows; i++) {
+        if (MATRIX_AT(m, i, j) > MATRIX_AT(m, best, j)) best = i;
+    }
+    return best;
+}
+
+static void* evaluate_range(void* arg) {
+    EvalTask* task = (EvalTask*)arg;
+    const NeuralNetwork* nn = task->nn;
+    int softmax = nn->layers[nn->num_layers - 1]->activation == ACTIVATION_SOFTMAX;
+
+    // Activation buffers for one batch, reused for every batch of the range
+    Matrix** buffers = (Matrix**)malloc(nn->num_layers * sizeof(Matrix*));
+    for (int l = 0; l < nn->num_layers; l++) {
+        buffers[l] = matrix_create(nn->layers[l]->output_size, task->batch_size);
+    }
+
+    for (int start = task->first; start < task->last; start += task->batch_size) {
+        int count = task->last - start < task->batch_size ? task->last - start : task->batch_size;
+        Matrix input = matrix_slice_cols(task->inputs, start, count);
+        Matrix target = matrix_slice_cols(task->targets, start, count);
+
+        const Matrix* current = &input;
+        Matrix outputs[2];
+        for (int l = 0; l < nn->num_layers; l++) {
+            outputs[l % 2] = matrix_view(buffers[l], 0, 0, buffers[l]->rows, count);
+            layer_infer(nn->layers[l], current, &outputs[l % 2]);
+            current = &outputs[l % 2];
+        }
+
+        for (int j = 0; j < count; j++) {
+            double loss = 0.0;
+            for (int i = 0; i < current->rows; i++) {
+                double p = MATRIX_AT(current, i, j);
+                double t = MATRIX_AT(&target, i, j);
+                if (softmax) {
+                    if (t != 0.0) loss -= t * log(p > 1e-300 ? p : 1e-300);
+                } else {
+                    loss += (p - t) * (p - t) / current->rows;
+                }
+            }
+            task->loss_sum += loss;
+
+            if (current->rows == 1) {
+                task->correct += (MATRIX_AT(current, 0, j) >= 0.5) == (MATRIX_AT(&target, 0, j) >= 0.5);
+            } else {
+                task->correct += argmax_column(current, j) == argmax_column(&target, j);
+            }
+        }
+    }
+
+    for (int l = 0; l < nn->num_layers; l++) matrix_free(buffers[l]);
+    free(buffers);
+    return NULL;
+}
+
+// Embedding layers take columns of token ids, so any number of rows
+static int check_eval_shapes(const NeuralNetwork* nn, const Matrix* inputs, const Matrix* targets) {
+    const Layer* first = nn->layers[0];
+    const Layer* last = nn->layers[nn->num_layers - 1];
+    if (first->type != LAYER_EMBEDDING && inputs->rows != first->input_size) {
+        fprintf(stderr, "Error: Evaluation inputs have %d rows, the network takes %d\n",
+                inputs->rows, first->input_size);
+        return 1;
+    }
+    if (targets->rows != last->output_size) {
+        fprintf(stderr, "Error: Evaluation targets have %d rows, the network outputs %d\n",
+                targets->rows, last->output_size);
+        return 1;
+    }
+    if (targets->cols != inputs->cols) {
+        fprintf(stderr, "Error: %d evaluation inputs but %d targets\n", inputs->cols, targets->cols);
+        return 1;
+    }
+    return 0;
+}
+
+EvalResult nn_evaluate(const NeuralNetwork* nn, const Matrix* inputs, const Matrix* targets,
+                       int batch_size, int num_threads) {
+    EvalResult result = { 0.0, 0.0, 0, 0.0 };
+    if (check_eval_shapes(nn, inputs, targets)) return result;
+    result.count = inputs->cols;
+    if (inputs->cols == 0) return result;
+    if (batch_size < 1) batch_size = EVAL_DEFAULT_BATCH;
+
+    // Whole batches per thread
+    int num_batches = (inputs->cols + batch_size - 1) / batch_size;
+    if (num_threads < 1) num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads > EVAL_MAX_THREADS) num_threads = EVAL_MAX_THREADS;
+    if (num_threads > num_batches) num_threads = num_batches;
+    if (num_threads < 1) num_threads = 1;
+
+    double start = profiler_now();
+    EvalTask tasks[EVAL_MAX_THREADS];
+    pthread_t threads[EVAL_MAX_THREADS];
+    for (int t = 0; t < num_threads; t++) {
+        int first = (int)((long)num_batches * t / num_threads) * batch_size;
+        int last = (int)((long)num_batches * (t + 1) / num_threads) * batch_size;
+        EvalTask task = { nn, inputs, targets, first, last < inputs->cols ? last : inputs->cols,
+                          batch_size, 0.0, 0 };
+        tasks[t] = task;
+    }
+
+    // The calling thread takes the first share
+    for (int t = 1; t < num_threads; t++) {
+        pthread_create(&threads[t], NULL, evaluate_range, &tasks[t]);
+    }
+    evaluate_range(&tasks[0]);
+    for (int t = 1; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    double loss_sum = 0.0;
+    int correct = 0;
+    for (int t = 0; t < num_threads; t++) {
+        loss_sum += tasks[t].loss_sum;
+        correct += tasks[t].correct;
+    }
+    result.loss = loss_sum / inputs->cols;
+    result.accuracy = (double)correct / inputs->cols;
+    result.seconds = profiler_now() - start;
+    return result;
+}
+
+EarlyStopping* early_stopping_create(const Matrix* inputs, const Matrix* targets, int patience) {
+    if (inputs->cols == 0 || targets->cols != inputs->cols) {
+        fprintf(stderr, "Error: Validation set has %d inputs and %d targets\n", inputs->cols, targets->cols);
+        return NULL;
+    }
+
+    EarlyStopping* stopping = (EarlyStopping*)calloc(1, sizeof(EarlyStopping));
+    stopping->inputs = inputs;
+    stopping->targets = targets;
+    stopping->patience = patience;
+    stopping->min_delta = 0.0;
+    stopping->batch_size = EVAL_DEFAULT_BATCH;
+    stopping->num_threads = 0;
+    stopping->best_epoch = -1;
+    stopping->stopped_epoch = -1;
+    return stopping;
+}
+
+void early_stopping_free(EarlyStopping* stopping) {
+    if (stopping == NULL) return;
+    for (int i = 0; i < stopping->num_layers; i++) {
+        matrix_free(stopping->best_weights[i]);
+        matrix_free(stopping->best_biases[i]);
+    }
+    free(stopping->best_weights);
+    free(stopping->best_biases);
+    free(stopping);
+}
+
+static void copy_into(Matrix* dest, const Matrix* src) {
+    for (int i = 0; i < src->rows; i++) {
+        memcpy(matrix_row(dest, i), matrix_row(src, i), src->cols * sizeof(double));
+    }
+}
+
+// Keep a copy of the current parameters as the best so far
+static void save_best(EarlyStopping* stopping, const NeuralNetwork* nn) {
+    if (stopping->best_weights == NULL) {
+        stopping->num_layers = nn->num_layers;
+        stopping->best_weights = (Matrix**)calloc(nn->num_layers, sizeof(Matrix*));
+        stopping->best_biases = (Matrix**)calloc(nn->num_layers, sizeof(Matrix*));
+        for (int i = 0; i < nn->num_layers; i++) {
+            Layer* layer = nn->layers[i];
+            stopping->best_weights[i] = matrix_create(layer->weights->rows, layer->weights->cols);
+            if (layer->biases) stopping->best_biases[i] = matrix_create(layer->biases->rows, 1);
+        }
+    }
+
+    for (int i = 0; i < nn->num_layers; i++) {
+        copy_into(stopping->best_weights[i], nn->layers[i]->weights);
+        if (nn->layers[i]->biases) copy_into(stopping->best_biases[i], nn->layers[i]->biases);
+    }
+}
+
+static void restore_best(const EarlyStopping* stopping, NeuralNetwork* nn) {
+    for (int i = 0; i < nn->num_layers; i++) {
+        copy_into(nn->layers[i]->weights, stopping->best_weights[i]);
+        if (nn->layers[i]->biases) copy_into(nn->layers[i]->biases, stopping->best_biases[i]);
+    }
+}
+
+int early_stopping_end_epoch(EarlyStopping* stopping, NeuralNetwork* nn, int epoch, int epochs) {
+    // A validation set that does not fit the network ends training as is
+    if (check_eval_shapes(nn, stopping->inputs, stopping->targets)) {
+        stopping->stopped_epoch = epoch;
+        return 1;
+    }
+
+    stopping->last = nn_evaluate(nn, stopping->inputs, stopping->targets,
+                                 stopping->batch_size, stopping->num_threads);
+    stopping->evaluation_seconds += stopping->last.seconds;
+
+    if (stopping->best_epoch < 0 || stopping->last.loss < stopping->best_loss - stopping->min_delta) {
+        stopping->best_loss = stopping->last.loss;
+        stopping->best_epoch = epoch;
+        stopping->epochs_without_improvement = 0;
+        save_best(stopping, nn);
+    } else {
+        stopping->epochs_without_improvement++;
+    }
+
+    if (stopping->verbose) {
+        printf("Epoch %d - Validation loss: %.6f - Accuracy: %.1f%%%s\n", epoch + 1,
+               stopping->last.loss, stopping->last.accuracy * 100,
+               stopping->best_epoch == epoch ? " (best)" : "");
+    }
+
+    int stop = stopping->epochs_without_improvement >= stopping->patience;
+    if (stop) stopping->stopped_epoch = epoch;
+    if ((stop || epoch + 1 == epochs) && stopping->best_epoch != epoch) {
+        restore_best(stopping, nn);
+    }
+    return stop;
+}
@@ -0,0 +1,55 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "neural_network.h"
+
+typedef struct {
+    double loss;       // Cross-entropy per example for softmax outputs, else MSE
+    double accuracy;   // Argmax match, or prediction and target on the same side of 0.5 for one output
+    int count;
+    double seconds;
+} EvalResult;
+
+// Evaluate a held-out set given as one example per column (e.g. a dataset
+// cache view). Examples are run in batches of batch_size through
+// layer_infer() on num_threads threads (0: one per CPU), each with its own
+// activation buffers, so the network's training caches are untouched.
+// Returns a zero result (count 0) if the shapes do not fit the network.
+EvalResult nn_evaluate(const NeuralNetwork* nn, const Matrix* inputs, const Matrix* targets,
+                       int batch_size, int num_threads);
+
+// Stop training once the validation loss has not improved by min_delta
+// for `patience` epochs. Attach with `nn->early_stopping = stopping;` (not
+// owned); the training loops then evaluate after every epoch and end
+// early. The weights of the best epoch are kept and restored when training
+// stops, early or not.
+typedef struct EarlyStopping {
+    const Matrix* inputs;
+    const Matrix* targets;
+    int patience;
+    double min_delta;
+    int batch_size;
+    int num_threads;
+    int verbose;            // Print the validation result after every epoch
+
+    // State
+    double best_loss;
+    int best_epoch;         // -1 before the first evaluation
+    int epochs_without_improvement;
+    int stopped_epoch;      // Last epoch run if training ended early, else -1
+    EvalResult last;
+    int num_layers;
+    Matrix** best_weights;
+    Matrix** best_biases;
+    double evaluation_seconds;
+} EarlyStopping;
+
+// Defaults: min_delta 0, batches of 64, one thread per CPU. Returns NULL
+// for an empty set or one with different numbers of inputs and targets; a
+// set that does not fit the network stops training at the first epoch.
+EarlyStopping* early_stopping_create(const Matrix* inputs, const Matrix* targets, int patience);
+void early_stopping_free(EarlyStopping* stopping);
+// Called by the training loops after each epoch; returns 1 to stop
+int early_stopping_end_epoch(EarlyStopping* stopping, NeuralNetwork* nn, int epoch, int epochs);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "matrix.h"
+
+// Blocking parameters of the packed GEMM kernel behind matrix_gemm().
+// op(a) is packed in mc x kc blocks and op(b) in kc x nc panels, and an
+// mr x nr micro-kernel accumulates one tile of c in registers. Products
+// large enough are split over up to `threads` threads by rows of c; the
+// threads pack each panel of op(b) once, into a buffer they share.
+// matrix_gemm_strassen() recurses while every dimension exceeds
+// strassen_cutoff (see strassen.h).
+typedef struct {
+    int mc, kc, nc;
+    int mr, nr;     // One of the shapes in gemm_micro_kernels
+    int threads;
+    int strassen_cutoff;
+} GemmConfig;
+
+typedef struct {
+    int mr, nr;
+} GemmMicroKernel;
+
+extern const GemmMicroKernel gemm_micro_kernels[];
+extern const int gemm_num_micro_kernels;
+
+// Active configuration. On first use it is loaded from the file named by
+// $ML_GEMM_CONFIG, else $HOME/.ml_gemm_config (written by matrix_autotune),
+// and otherwise derived from the cache sizes reported by sysconf().
+GemmConfig gemm_config(void);
+// Replace the active configuration; returns 1 if it is invalid
+int gemm_set_config(const GemmConfig* config);
+GemmConfig gemm_default_config(void);
+// Default file location, or NULL without $ML_GEMM_CONFIG and $HOME
+const char* gemm_config_path(void);
+// key=value text file; both return 1 on failure
+int gemm_config_load(const char* path, GemmConfig* config);
+int gemm_config_save(const char* path, const GemmConfig* config);
+int gemm_config_valid(const GemmConfig* config);
+
+// c += alpha * op(a) * op(b) with the packed kernel; shapes are checked
+// by matrix_gemm()
+void gemm_blocked(Matrix* c, const Matrix* a, int transpose_a, const Matrix* b, int transpose_b,
+                  double alpha, const GemmConfig* config);
+
+#endif
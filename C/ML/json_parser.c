@@ -4,131 +4,459 @@
 #include <string.h>
 #include <ctype.h>
 
-#define MAX_LINE_LENGTH 2048
-#define MAX_TEXT_LENGTH 1024
+#define JSON_READ_BUFFER_SIZE 65536  // Bytes read from the file per refill
+#define JSON_INITIAL_STRING_CAPACITY 256
+#define JSON_MAX_NUMBER_LENGTH 64
+#define JSON_MAX_DEPTH 512           // Guards the recursive parser's stack
 
-// Skip whitespace in string
-char* skip_whitespace(char* str) {
-    while (*str && isspace(*str)) str++;
-    return str;
+JsonTokenizer* json_tokenizer_create(FILE* file) {
+    JsonTokenizer* tokenizer = (JsonTokenizer*)malloc(sizeof(JsonTokenizer));
+    tokenizer->file = file;
+    tokenizer->buffer = (char*)malloc(JSON_READ_BUFFER_SIZE);
+    tokenizer->buffer_len = 0;
+    tokenizer->buffer_pos = 0;
+    tokenizer->string_capacity = JSON_INITIAL_STRING_CAPACITY;
+    tokenizer->string = (char*)malloc(tokenizer->string_capacity);
+    tokenizer->string[0] = '\0';
+    tokenizer->string_len = 0;
+    tokenizer->number = 0.0;
+    tokenizer->line = 1;
+    tokenizer->column = 1;
+    tokenizer->error = NULL;
+    return tokenizer;
 }
 
-// Extract string value between quotes (skips field name, gets value)
-char* extract_string(char* str, char* output, int max_len) {
-    // Find the colon (separator between field name and value)
-    char* colon = strchr(str, ':');
-    if (!colon) return NULL;
+void json_tokenizer_free(JsonTokenizer* tokenizer) {
+    if (tokenizer == NULL) return;
+    free(tokenizer->buffer);
+    free(tokenizer->string);
+    free(tokenizer);
+}
 
-    // Find the opening quote after the colon
-    char* start = strchr(colon, '"');
-    if (!start) return NULL;
-    start++; // Skip opening quote
+// Look at the next byte without consuming it, refilling the buffer as needed
+static int peek_char(JsonTokenizer* t) {
+    if (t->buffer_pos >= t->buffer_len) {
+        t->buffer_len = fread(t->buffer, 1, JSON_READ_BUFFER_SIZE, t->file);
+        t->buffer_pos = 0;
+        if (t->buffer_len == 0) return EOF;
+    }
+    return (unsigned char)t->buffer[t->buffer_pos];
+}
 
-    char* end = start;
-    int len = 0;
+static int next_char(JsonTokenizer* t) {
+    int c = peek_char(t);
+    if (c == EOF) return EOF;
+    t->buffer_pos++;
+    if (c == '\n') {
+        t->line++;
+        t->column = 1;
+    } else {
+        t->column++;
+    }
+    return c;
+}
 
-    // Find closing quote, handling escaped quotes
-    while (*end && *end != '"' && len < max_len - 1) {
-        if (*end == '\\' && *(end + 1) == '"') {
-            output[len++] = '"';
-            end += 2;
-        } else {
-            output[len++] = *end++;
-        }
+static JsonTokenType token_error(JsonTokenizer* t, const char* message) {
+    t->error = message;
+    return JSON_TOKEN_ERROR;
+}
+
+// Append one byte to the string token, doubling its buffer when full
+static void string_append(JsonTokenizer* t, char c) {
+    if (t->string_len + 1 >= t->string_capacity) {
+        t->string_capacity *= 2;
+        t->string = (char*)realloc(t->string, t->string_capacity);
     }
+    t->string[t->string_len++] = c;
+}
 
-    output[len] = '\0';
-    return end + 1; // Return position after closing quote
+// Append a run of plain bytes to the string token
+static void string_append_run(JsonTokenizer* t, const char* bytes, size_t len) {
+    while (t->string_len + len >= t->string_capacity) {
+        t->string_capacity *= 2;
+        t->string = (char*)realloc(t->string, t->string_capacity);
+    }
+    memcpy(t->string + t->string_len, bytes, len);
+    t->string_len += len;
 }
 
-// Extract double value
-double extract_double(char* str) {
-    char* colon = strchr(str, ':');
-    if (!colon) return 0.0;
-    return atof(colon + 1);
+// Append a code point as UTF-8
+static void string_append_utf8(JsonTokenizer* t, unsigned long cp) {
+    if (cp < 0x80) {
+        string_append(t, (char)cp);
+    } else if (cp < 0x800) {
+        string_append(t, (char)(0xC0 | (cp >> 6)));
+        string_append(t, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        string_append(t, (char)(0xE0 | (cp >> 12)));
+        string_append(t, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        string_append(t, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        string_append(t, (char)(0xF0 | (cp >> 18)));
+        string_append(t, (char)(0x80 | ((cp >> 12) & 0x3F)));
+        string_append(t, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        string_append(t, (char)(0x80 | (cp & 0x3F)));
+    }
 }
 
-// Count number of training examples in file
-int count_examples(FILE* file) {
-    int count = 0;
-    char line[MAX_LINE_LENGTH];
+// Read the four hex digits of a \u escape
+static long read_hex4(JsonTokenizer* t) {
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        int c = next_char(t);
+        if (c == EOF || !isxdigit(c)) return -1;
+        value = (value << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+    }
+    return value;
+}
+
+// Read a string token; the opening quote has already been consumed
+static JsonTokenType read_string(JsonTokenizer* t) {
+    t->string_len = 0;
 
-    rewind(file);
+    for (;;) {
+        // Copy unescaped runs straight out of the read buffer
+        if (peek_char(t) != EOF) {
+            size_t start = t->buffer_pos;
+            size_t end = start;
+            while (end < t->buffer_len) {
+                unsigned char b = (unsigned char)t->buffer[end];
+                if (b == '"' || b == '\\' || b < 0x20) break;
+                end++;
+            }
+            if (end > start) {
+                string_append_run(t, t->buffer + start, end - start);
+                t->buffer_pos = end;
+                t->column += (int)(end - start);
+                continue;
+            }
+        }
 
-    while (fgets(line, sizeof(line), file)) {
-        if (strstr(line, "\"text\"")) {
-            count++;
+        int c = next_char(t);
+        if (c == EOF) return token_error(t, "unterminated string");
+        if (c == '"') break;
+        if (c < 0x20) return token_error(t, "control character in string");
+
+        if (c != '\\') {
+            string_append(t, (char)c);
+            continue;
+        }
+
+        c = next_char(t);
+        switch (c) {
+            case '"':  string_append(t, '"'); break;
+            case '\\': string_append(t, '\\'); break;
+            case '/':  string_append(t, '/'); break;
+            case 'b':  string_append(t, '\b'); break;
+            case 'f':  string_append(t, '\f'); break;
+            case 'n':  string_append(t, '\n'); break;
+            case 'r':  string_append(t, '\r'); break;
+            case 't':  string_append(t, '\t'); break;
+            case 'u': {
+                long cp = read_hex4(t);
+                if (cp < 0) return token_error(t, "invalid \\u escape");
+
+                // Combine UTF-16 surrogate pairs into one code point
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    if (next_char(t) != '\\' || next_char(t) != 'u') {
+                        return token_error(t, "unpaired surrogate in \\u escape");
+                    }
+                    long low = read_hex4(t);
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return token_error(t, "unpaired surrogate in \\u escape");
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return token_error(t, "unpaired surrogate in \\u escape");
+                }
+                string_append_utf8(t, (unsigned long)cp);
+                break;
+            }
+            default:
+                return token_error(t, "invalid escape sequence");
         }
     }
 
-    rewind(file);
-    return count;
+    t->string[t->string_len] = '\0';
+    return JSON_TOKEN_STRING;
 }
 
-TrainingDataset* load_training_data(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Could not open file '%s'\n", filename);
-        return NULL;
+// RFC 8259: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?, which is
+// stricter than strtod (no "1.", "01" or ".5")
+static int valid_number(const char* p) {
+    if (*p == '-') p++;
+    if (*p == '0') {
+        p++;
+    } else if (isdigit((unsigned char)*p)) {
+        while (isdigit((unsigned char)*p)) p++;
+    } else {
+        return 0;
+    }
+    if (*p == '.') {
+        p++;
+        if (!isdigit((unsigned char)*p)) return 0;
+        while (isdigit((unsigned char)*p)) p++;
+    }
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        if (*p == '+' || *p == '-') p++;
+        if (!isdigit((unsigned char)*p)) return 0;
+        while (isdigit((unsigned char)*p)) p++;
     }
+    return *p == '\0';
+}
 
-    // Count examples first
-    int num_examples = count_examples(file);
-    if (num_examples == 0) {
-        fprintf(stderr, "Error: No training examples found in file\n");
-        fclose(file);
-        return NULL;
+// Read a number token whose first character is `first`
+static JsonTokenType read_number(JsonTokenizer* t, int first) {
+    char text[JSON_MAX_NUMBER_LENGTH + 1];
+    int len = 0;
+    text[len++] = (char)first;
+
+    for (;;) {
+        int c = peek_char(t);
+        if (c == EOF || !(isdigit(c) || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')) {
+            break;
+        }
+        if (len >= JSON_MAX_NUMBER_LENGTH) return token_error(t, "number too long");
+        text[len++] = (char)next_char(t);
     }
+    text[len] = '\0';
+    if (!valid_number(text)) return token_error(t, "invalid number");
 
-    // Allocate dataset
-    TrainingDataset* dataset = (TrainingDataset*)malloc(sizeof(TrainingDataset));
-    dataset->count = num_examples;
-    dataset->examples = (TrainingExample*)malloc(num_examples * sizeof(TrainingExample));
-
-    // Parse file
-    char line[MAX_LINE_LENGTH];
-    int example_index = 0;
-    char current_text[MAX_TEXT_LENGTH] = "";
-    double current_label = 0.0;
-    int has_text = 0;
+    char* end;
+    t->number = strtod(text, &end);
+    if (end != text + len) return token_error(t, "invalid number");
+    return JSON_TOKEN_NUMBER;
+}
+
+// Match the remainder of true/false/null
+static JsonTokenType read_literal(JsonTokenizer* t, const char* rest, JsonTokenType type) {
+    for (const char* p = rest; *p; p++) {
+        if (next_char(t) != *p) return token_error(t, "invalid literal");
+    }
+    return type;
+}
+
+JsonTokenType json_next_token(JsonTokenizer* t) {
+    int c;
+    do {
+        c = next_char(t);
+    } while (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+
+    // Skip a UTF-8 byte order mark at the start of the file
+    if (c == 0xEF && t->line == 1 && t->column == 2) {
+        if (next_char(t) != 0xBB || next_char(t) != 0xBF) {
+            return token_error(t, "unexpected character");
+        }
+        return json_next_token(t);
+    }
+
+    switch (c) {
+        case EOF: return JSON_TOKEN_END;
+        case '{': return JSON_TOKEN_OBJECT_START;
+        case '}': return JSON_TOKEN_OBJECT_END;
+        case '[': return JSON_TOKEN_ARRAY_START;
+        case ']': return JSON_TOKEN_ARRAY_END;
+        case ':': return JSON_TOKEN_COLON;
+        case ',': return JSON_TOKEN_COMMA;
+        case '"': return read_string(t);
+        case 't': return read_literal(t, "rue", JSON_TOKEN_TRUE);
+        case 'f': return read_literal(t, "alse", JSON_TOKEN_FALSE);
+        case 'n': return read_literal(t, "ull", JSON_TOKEN_NULL);
+        default:
+            if (c == '-' || isdigit(c)) return read_number(t, c);
+            return token_error(t, "unexpected character");
+    }
+}
+
+// Parser state shared by the recursive descent below
+typedef struct {
+    JsonTokenizer* tokenizer;
+    TrainingExampleCallback callback;
+    void* user_data;
+    long count;
+    int stopped;
+} StreamState;
+
+static int parse_value(StreamState* s, JsonTokenType token, int depth);
+
+static int parse_error(StreamState* s, const char* message) {
+    if (s->tokenizer->error == NULL) s->tokenizer->error = message;
+    return -1;
+}
+
+// Parse the members of an object; if it holds both "text" and "label" it is
+// delivered as an example once its closing brace has been read
+static int parse_object(StreamState* s, int depth) {
+    JsonTokenizer* t = s->tokenizer;
+    char* text = NULL;
+    double label = 0.0;
     int has_label = 0;
+    int result = 0;
 
-    while (fgets(line, sizeof(line), file)) {
-        char* trimmed = skip_whitespace(line);
+    JsonTokenType token = json_next_token(t);
+    if (token != JSON_TOKEN_OBJECT_END) {
+        for (;;) {
+            if (token != JSON_TOKEN_STRING) {
+                result = parse_error(s, "expected object key");
+                break;
+            }
+            int is_text = strcmp(t->string, "text") == 0;
+            int is_label = strcmp(t->string, "label") == 0;
 
-        // Check for "text" field
-        if (strstr(trimmed, "\"text\"")) {
-            char text_buffer[MAX_TEXT_LENGTH];
-            if (extract_string(trimmed, text_buffer, MAX_TEXT_LENGTH)) {
-                strcpy(current_text, text_buffer);
-                has_text = 1;
+            if (json_next_token(t) != JSON_TOKEN_COLON) {
+                result = parse_error(s, "expected ':' after object key");
+                break;
             }
-        }
 
-        // Check for "label" field
-        if (strstr(trimmed, "\"label\"")) {
-            current_label = extract_double(trimmed);
-            has_label = 1;
+            token = json_next_token(t);
+            if (is_text && token == JSON_TOKEN_STRING) {
+                text = (char*)realloc(text, t->string_len + 1);
+                memcpy(text, t->string, t->string_len + 1);
+            } else if (is_label && token == JSON_TOKEN_NUMBER) {
+                label = t->number;
+                has_label = 1;
+            } else if (is_label && (token == JSON_TOKEN_TRUE || token == JSON_TOKEN_FALSE)) {
+                label = token == JSON_TOKEN_TRUE ? 1.0 : 0.0;
+                has_label = 1;
+            } else if (parse_value(s, token, depth + 1) != 0) {
+                result = -1;
+                break;
+            }
+            if (s->stopped) break;
+
+            token = json_next_token(t);
+            if (token == JSON_TOKEN_OBJECT_END) break;
+            if (token != JSON_TOKEN_COMMA) {
+                result = parse_error(s, "expected ',' or '}' in object");
+                break;
+            }
+            token = json_next_token(t);
         }
+    }
 
-        // When we have both text and label, create an example
-        if (has_text && has_label && example_index < num_examples) {
-            dataset->examples[example_index].text = strdup(current_text);
-            dataset->examples[example_index].label = current_label;
-            example_index++;
-            has_text = 0;
-            has_label = 0;
+    if (result == 0 && !s->stopped && text != NULL && has_label) {
+        TrainingExample example;
+        example.text = text;
+        example.label = label;
+        s->count++;
+        if (s->callback(&example, s->user_data) != 0) {
+            s->stopped = 1;
         }
     }
 
+    free(text);
+    return result;
+}
+
+static int parse_array(StreamState* s, int depth) {
+    JsonTokenType token = json_next_token(s->tokenizer);
+    if (token == JSON_TOKEN_ARRAY_END) return 0;
+
+    for (;;) {
+        if (parse_value(s, token, depth + 1) != 0) return -1;
+        if (s->stopped) return 0;
+
+        token = json_next_token(s->tokenizer);
+        if (token == JSON_TOKEN_ARRAY_END) return 0;
+        if (token != JSON_TOKEN_COMMA) return parse_error(s, "expected ',' or ']' in array");
+        token = json_next_token(s->tokenizer);
+    }
+}
+
+// Parse one value whose first token has already been read
+static int parse_value(StreamState* s, JsonTokenType token, int depth) {
+    if (depth > JSON_MAX_DEPTH) return parse_error(s, "nesting too deep");
+
+    switch (token) {
+        case JSON_TOKEN_OBJECT_START:
+            return parse_object(s, depth);
+        case JSON_TOKEN_ARRAY_START:
+            return parse_array(s, depth);
+        case JSON_TOKEN_STRING:
+        case JSON_TOKEN_NUMBER:
+        case JSON_TOKEN_TRUE:
+        case JSON_TOKEN_FALSE:
+        case JSON_TOKEN_NULL:
+            return 0;
+        case JSON_TOKEN_ERROR:
+            return -1;
+        default:
+            return parse_error(s, "unexpected token");
+    }
+}
+
+long stream_training_data(const char* filename, TrainingExampleCallback callback, void* user_data) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file '%s'\n", filename);
+        return -1;
+    }
+
+    StreamState state;
+    state.tokenizer = json_tokenizer_create(file);
+    state.callback = callback;
+    state.user_data = user_data;
+    state.count = 0;
+    state.stopped = 0;
+
+    int result = parse_value(&state, json_next_token(state.tokenizer), 0);
+    if (result == 0 && !state.stopped && json_next_token(state.tokenizer) != JSON_TOKEN_END) {
+        result = parse_error(&state, "trailing data after top-level value");
+    }
+
+    if (result != 0) {
+        fprintf(stderr, "Error: Invalid JSON in '%s' at line %d, column %d: %s\n",
+                filename, state.tokenizer->line, state.tokenizer->column,
+                state.tokenizer->error ? state.tokenizer->error : "parse error");
+    }
+
+    json_tokenizer_free(state.tokenizer);
     fclose(file);
+    return result == 0 ? state.count : -1;
+}
+
+// Collects streamed examples into a growable array
+typedef struct {
+    TrainingExample* examples;
+    int count;
+    int capacity;
+} DatasetBuilder;
 
-    if (example_index != num_examples) {
-        fprintf(stderr, "Warning: Expected %d examples but parsed %d\n",
-                num_examples, example_index);
-        dataset->count = example_index;
+static int collect_example(const TrainingExample* example, void* user_data) {
+    DatasetBuilder* builder = (DatasetBuilder*)user_data;
+
+    if (builder->count == builder->capacity) {
+        builder->capacity = builder->capacity ? builder->capacity * 2 : 64;
+        builder->examples = (TrainingExample*)realloc(builder->examples,
+                                                      builder->capacity * sizeof(TrainingExample));
     }
 
+    builder->examples[builder->count].text = strdup(example->text);
+    builder->examples[builder->count].label = example->label;
+    builder->count++;
+    return 0;
+}
+
+TrainingDataset* load_training_data(const char* filename) {
+    DatasetBuilder builder = { NULL, 0, 0 };
+
+    long parsed = stream_training_data(filename, collect_example, &builder);
+    if (parsed <= 0) {
+        if (parsed == 0) {
+            fprintf(stderr, "Error: No training examples found in file\n");
+        }
+        for (int i = 0; i < builder.count; i++) {
+            free(builder.examples[i].text);
+        }
+        free(builder.examples);
+        return NULL;
+    }
+
+    TrainingDataset* dataset = (TrainingDataset*)malloc(sizeof(TrainingDataset));
+    dataset->examples = (TrainingExample*)realloc(builder.examples,
+                                                  builder.count * sizeof(TrainingExample));
+    dataset->count = builder.count;
     return dataset;
 }
 
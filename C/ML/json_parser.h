@@ -1,6 +1,8 @@
 #ifndef JSON_PARSER_H
 #define JSON_PARSER_H
 
+#include <stdio.h>
+
 typedef struct {
     char* text;
     double label;
@@ -11,6 +13,56 @@ typedef struct {
     int count;
 } TrainingDataset;
 
+// Token types produced by the streaming tokenizer
+typedef enum {
+    JSON_TOKEN_ERROR,
+    JSON_TOKEN_END,
+    JSON_TOKEN_OBJECT_START,
+    JSON_TOKEN_OBJECT_END,
+    JSON_TOKEN_ARRAY_START,
+    JSON_TOKEN_ARRAY_END,
+    JSON_TOKEN_COLON,
+    JSON_TOKEN_COMMA,
+    JSON_TOKEN_STRING,
+    JSON_TOKEN_NUMBER,
+    JSON_TOKEN_TRUE,
+    JSON_TOKEN_FALSE,
+    JSON_TOKEN_NULL
+} JsonTokenType;
+
+// Single-pass streaming tokenizer. Reads the file through a fixed-size
+// buffer; only the current string token is held in memory, in a buffer
+// that grows to fit it.
+typedef struct {
+    FILE* file;
+    char* buffer;
+    size_t buffer_len;
+    size_t buffer_pos;
+
+    char* string;         // Decoded value of the last STRING token
+    size_t string_len;
+    size_t string_capacity;
+    double number;        // Value of the last NUMBER token
+
+    int line;
+    int column;
+    const char* error;    // Set when JSON_TOKEN_ERROR is returned
+} JsonTokenizer;
+
+// Called once per parsed example. The text is only valid for the duration
+// of the call; return non-zero to stop parsing early.
+typedef int (*TrainingExampleCallback)(const TrainingExample* example, void* user_data);
+
+// Tokenizer operations
+JsonTokenizer* json_tokenizer_create(FILE* file);
+void json_tokenizer_free(JsonTokenizer* tokenizer);
+JsonTokenType json_next_token(JsonTokenizer* tokenizer);
+
+// Stream every object with a "text" string and a numeric "label" to the
+// callback, in file order. Returns the number of examples delivered, or -1
+// if the file could not be opened or is not valid JSON.
+long stream_training_data(const char* filename, TrainingExampleCallback callback, void* user_data);
+
 // Load training data from JSON file
 TrainingDataset* load_training_data(const char* filename);
 
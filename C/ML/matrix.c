@@ -1,62 +1,175 @@
 #include "matrix.h"
-#include <time.h>
+#include "rng.h"
+#include "gemm.h"
+#include "matrix_pool.h"
+#include <pthread.h>
+#include <unistd.h>
+
+// Elements per thread below which random fills stay single-threaded
+#define RANDOM_FILL_GRAIN (1 << 16)
+// Multiply-adds above which GEMM takes the packed, blocked kernel; smaller
+// products and matrix-vector shapes do not repay the packing
+#define GEMM_BLOCKED_MIN_WORK (32 * 32 * 32)
+#define GEMM_BLOCKED_MIN_COLS 4
+
+// Updated atomically: matrices are also created on pipeline worker threads
+static unsigned long long alloc_count = 0;
+static unsigned long long alloc_bytes = 0;
 
 Matrix* matrix_create(int rows, int cols) {
+    __atomic_fetch_add(&alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&alloc_bytes, sizeof(Matrix) + (size_t)rows * cols * sizeof(double),
+                       __ATOMIC_RELAXED);
+
+    Matrix* m = matrix_pool_take((size_t)rows * cols);
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = cols;
+    memset(m->data, 0, (size_t)rows * cols * sizeof(double));
+    m->owns_data = 1;
+    return m;
+}
+
+Matrix* matrix_wrap(double* data, int rows, int cols) {
     Matrix* m = (Matrix*)malloc(sizeof(Matrix));
     m->rows = rows;
     m->cols = cols;
-    m->data = (double**)malloc(rows * sizeof(double*));
-    for (int i = 0; i < rows; i++) {
-        m->data[i] = (double*)calloc(cols, sizeof(double));
-    }
+    m->stride = cols;
+    m->data = data;
+    m->owns_data = 0;
     return m;
 }
 
+static Matrix empty_view(void) {
+    Matrix view = { 0, 0, 0, NULL, 0 };
+    return view;
+}
+
+Matrix matrix_view(const Matrix* m, int row, int col, int rows, int cols) {
+    if (row < 0 || col < 0 || rows < 0 || cols < 0 || row + rows > m->rows || col + cols > m->cols) {
+        fprintf(stderr, "View (%d,%d)+(%d,%d) is outside a (%d,%d) matrix\n",
+                row, col, rows, cols, m->rows, m->cols);
+        return empty_view();
+    }
+
+    Matrix view = { rows, cols, m->stride, m->data + (size_t)row * m->stride + col, 0 };
+    return view;
+}
+
+Matrix matrix_slice_rows(const Matrix* m, int start, int count) {
+    return matrix_view(m, start, 0, count, m->cols);
+}
+
+Matrix matrix_slice_cols(const Matrix* m, int start, int count) {
+    return matrix_view(m, 0, start, m->rows, count);
+}
+
+Matrix matrix_reshape(const Matrix* m, int rows, int cols) {
+    if ((long)rows * cols != (long)m->rows * m->cols) {
+        fprintf(stderr, "Cannot reshape (%d,%d) to (%d,%d)\n", m->rows, m->cols, rows, cols);
+        return empty_view();
+    }
+    if (!matrix_is_contiguous(m)) {
+        fprintf(stderr, "Cannot reshape a strided view; copy it first\n");
+        return empty_view();
+    }
+
+    Matrix view = { rows, cols, cols, m->data, 0 };
+    return view;
+}
+
 void matrix_free(Matrix* m) {
     if (m == NULL) return;
-    for (int i = 0; i < m->rows; i++) {
-        free(m->data[i]);
+    if (m->owns_data) {
+        matrix_pool_give(m);
+    } else {
+        free(m);
     }
-    free(m->data);
-    free(m);
 }
 
 Matrix* matrix_copy(Matrix* m) {
     Matrix* copy = matrix_create(m->rows, m->cols);
     for (int i = 0; i < m->rows; i++) {
-        for (int j = 0; j < m->cols; j++) {
-            copy->data[i][j] = m->data[i][j];
-        }
+        memcpy(matrix_row(copy, i), matrix_row(m, i), m->cols * sizeof(double));
     }
     return copy;
 }
 
 void matrix_fill(Matrix* m, double value) {
     for (int i = 0; i < m->rows; i++) {
+        double* row = matrix_row(m, i);
         for (int j = 0; j < m->cols; j++) {
-            m->data[i][j] = value;
+            row[j] = value;
         }
     }
 }
 
 void matrix_randomize(Matrix* m, double min, double max) {
-    for (int i = 0; i < m->rows; i++) {
-        for (int j = 0; j < m->cols; j++) {
-            double random = ((double)rand() / RAND_MAX);
-            m->data[i][j] = min + random * (max - min);
-        }
+    matrix_randomize_seeded(m, min, max, rng_seed_from_rand(), 0);
+}
+
+typedef struct {
+    Matrix* m;
+    int first_row;
+    int last_row;
+    double min;
+    double max;
+    uint64_t seed;
+    uint64_t stream;
+} RandomFillTask;
+
+static void* random_fill_rows(void* arg) {
+    RandomFillTask* task = (RandomFillTask*)arg;
+    Matrix* m = task->m;
+    for (int i = task->first_row; i < task->last_row; i++) {
+        // Element (i, j) is always value i * cols + j of the stream
+        rng_fill_uniform(matrix_row(m, i), m->cols, task->seed, task->stream,
+                         (uint64_t)i * m->cols, task->min, task->max);
+    }
+    return NULL;
+}
+
+void matrix_randomize_seeded(Matrix* m, double min, double max, uint64_t seed, uint64_t stream) {
+    long elements = (long)m->rows * m->cols;
+    long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads > elements / RANDOM_FILL_GRAIN) num_threads = elements / RANDOM_FILL_GRAIN;
+    if (num_threads > m->rows) num_threads = m->rows;
+    if (num_threads < 1) num_threads = 1;
+
+    RandomFillTask* tasks = (RandomFillTask*)malloc(num_threads * sizeof(RandomFillTask));
+    pthread_t* threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
+    for (long t = 0; t < num_threads; t++) {
+        tasks[t].m = m;
+        tasks[t].first_row = (int)(m->rows * t / num_threads);
+        tasks[t].last_row = (int)(m->rows * (t + 1) / num_threads);
+        tasks[t].min = min;
+        tasks[t].max = max;
+        tasks[t].seed = seed;
+        tasks[t].stream = stream;
+    }
+
+    // The calling thread takes the first share
+    for (long t = 1; t < num_threads; t++) {
+        pthread_create(&threads[t], NULL, random_fill_rows, &tasks[t]);
     }
+    random_fill_rows(&tasks[0]);
+    for (long t = 1; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    free(tasks);
+    free(threads);
 }
 
 void matrix_set(Matrix* m, int row, int col, double value) {
     if (row >= 0 && row < m->rows && col >= 0 && col < m->cols) {
-        m->data[row][col] = value;
+        MATRIX_AT(m, row, col) = value;
     }
 }
 
 double matrix_get(Matrix* m, int row, int col) {
     if (row >= 0 && row < m->rows && col >= 0 && col < m->cols) {
-        return m->data[row][col];
+        return MATRIX_AT(m, row, col);
     }
     return 0.0;
 }
@@ -69,8 +182,11 @@ Matrix* matrix_add(Matrix* a, Matrix* b) {
 
     Matrix* result = matrix_create(a->rows, a->cols);
     for (int i = 0; i < a->rows; i++) {
+        double* ra = matrix_row(a, i);
+        double* rb = matrix_row(b, i);
+        double* out = matrix_row(result, i);
         for (int j = 0; j < a->cols; j++) {
-            result->data[i][j] = a->data[i][j] + b->data[i][j];
+            out[j] = ra[j] + rb[j];
         }
     }
     return result;
@@ -84,8 +200,11 @@ Matrix* matrix_subtract(Matrix* a, Matrix* b) {
 
     Matrix* result = matrix_create(a->rows, a->cols);
     for (int i = 0; i < a->rows; i++) {
+        double* ra = matrix_row(a, i);
+        double* rb = matrix_row(b, i);
+        double* out = matrix_row(result, i);
         for (int j = 0; j < a->cols; j++) {
-            result->data[i][j] = a->data[i][j] - b->data[i][j];
+            out[j] = ra[j] - rb[j];
         }
     }
     return result;
@@ -99,23 +218,17 @@ Matrix* matrix_multiply(Matrix* a, Matrix* b) {
     }
 
     Matrix* result = matrix_create(a->rows, b->cols);
-    for (int i = 0; i < a->rows; i++) {
-        for (int j = 0; j < b->cols; j++) {
-            double sum = 0.0;
-            for (int k = 0; k < a->cols; k++) {
-                sum += a->data[i][k] * b->data[k][j];
-            }
-            result->data[i][j] = sum;
-        }
-    }
+    matrix_gemm(result, a, 0, b, 0, 1.0, 0.0);
     return result;
 }
 
 Matrix* matrix_multiply_scalar(Matrix* m, double scalar) {
     Matrix* result = matrix_create(m->rows, m->cols);
     for (int i = 0; i < m->rows; i++) {
+        double* in = matrix_row(m, i);
+        double* out = matrix_row(result, i);
         for (int j = 0; j < m->cols; j++) {
-            result->data[i][j] = m->data[i][j] * scalar;
+            out[j] = in[j] * scalar;
         }
     }
     return result;
@@ -124,8 +237,9 @@ Matrix* matrix_multiply_scalar(Matrix* m, double scalar) {
 Matrix* matrix_transpose(Matrix* m) {
     Matrix* result = matrix_create(m->cols, m->rows);
     for (int i = 0; i < m->rows; i++) {
+        double* in = matrix_row(m, i);
         for (int j = 0; j < m->cols; j++) {
-            result->data[j][i] = m->data[i][j];
+            MATRIX_AT(result, j, i) = in[j];
         }
     }
     return result;
@@ -139,19 +253,123 @@ Matrix* matrix_hadamard(Matrix* a, Matrix* b) {
 
     Matrix* result = matrix_create(a->rows, a->cols);
     for (int i = 0; i < a->rows; i++) {
+        double* ra = matrix_row(a, i);
+        double* rb = matrix_row(b, i);
+        double* out = matrix_row(result, i);
         for (int j = 0; j < a->cols; j++) {
-            result->data[i][j] = a->data[i][j] * b->data[i][j];
+            out[j] = ra[j] * rb[j];
+        }
+    }
+    return result;
+}
+
+Matrix* matrix_add_column(Matrix* m, Matrix* column) {
+    if (column->rows != m->rows || column->cols != 1) {
+        fprintf(stderr, "Column must be (%d,1) to broadcast over (%d,%d)\n",
+                m->rows, m->rows, m->cols);
+        return NULL;
+    }
+
+    Matrix* result = matrix_create(m->rows, m->cols);
+    for (int i = 0; i < m->rows; i++) {
+        double value = MATRIX_AT(column, i, 0);
+        double* in = matrix_row(m, i);
+        double* out = matrix_row(result, i);
+        for (int j = 0; j < m->cols; j++) {
+            out[j] = in[j] + value;
+        }
+    }
+    return result;
+}
+
+Matrix* matrix_sum_columns(Matrix* m) {
+    Matrix* result = matrix_create(m->rows, 1);
+    for (int i = 0; i < m->rows; i++) {
+        double* in = matrix_row(m, i);
+        double sum = 0.0;
+        for (int j = 0; j < m->cols; j++) {
+            sum += in[j];
         }
+        MATRIX_AT(result, i, 0) = sum;
     }
     return result;
 }
 
+int matrix_gemm(Matrix* c, Matrix* a, int transpose_a, Matrix* b, int transpose_b,
+                double alpha, double beta) {
+    int m = transpose_a ? a->cols : a->rows;
+    int k = transpose_a ? a->rows : a->cols;
+    int kb = transpose_b ? b->cols : b->rows;
+    int n = transpose_b ? b->rows : b->cols;
+    if (k != kb || c->rows != m || c->cols != n) {
+        fprintf(stderr, "Matrix dimensions incompatible for GEMM: (%d,%d)%s x (%d,%d)%s -> (%d,%d)\n",
+                a->rows, a->cols, transpose_a ? "^T" : "", b->rows, b->cols,
+                transpose_b ? "^T" : "", c->rows, c->cols);
+        return 1;
+    }
+
+    for (int i = 0; i < m; i++) {
+        double* out = matrix_row(c, i);
+        for (int j = 0; j < n; j++) {
+            out[j] = beta == 0.0 ? 0.0 : out[j] * beta;
+        }
+    }
+
+    if ((double)m * n * k >= GEMM_BLOCKED_MIN_WORK && n >= GEMM_BLOCKED_MIN_COLS &&
+        m >= GEMM_BLOCKED_MIN_COLS) {
+        GemmConfig config = gemm_config();
+        gemm_blocked(c, a, transpose_a, b, transpose_b, alpha, &config);
+        return 0;
+    }
+
+    // Loop orders keep the innermost loop on contiguous rows
+    if (!transpose_b) {
+        for (int i = 0; i < m; i++) {
+            double* out = matrix_row(c, i);
+            for (int p = 0; p < k; p++) {
+                double scale = alpha * (transpose_a ? MATRIX_AT(a, p, i) : MATRIX_AT(a, i, p));
+                double* rb = matrix_row(b, p);
+                for (int j = 0; j < n; j++) {
+                    out[j] += scale * rb[j];
+                }
+            }
+        }
+    } else if (!transpose_a) {
+        // a * b^T: dot products of rows of a with rows of b
+        for (int i = 0; i < m; i++) {
+            double* ra = matrix_row(a, i);
+            double* out = matrix_row(c, i);
+            for (int j = 0; j < n; j++) {
+                double* rb = matrix_row(b, j);
+                double sum = 0.0;
+                for (int p = 0; p < k; p++) {
+                    sum += ra[p] * rb[p];
+                }
+                out[j] += alpha * sum;
+            }
+        }
+    } else {
+        for (int i = 0; i < m; i++) {
+            double* out = matrix_row(c, i);
+            for (int j = 0; j < n; j++) {
+                double* rb = matrix_row(b, j);
+                double sum = 0.0;
+                for (int p = 0; p < k; p++) {
+                    sum += MATRIX_AT(a, p, i) * rb[p];
+                }
+                out[j] += alpha * sum;
+            }
+        }
+    }
+    return 0;
+}
+
 void matrix_print(Matrix* m) {
     printf("Matrix (%d x %d):\n", m->rows, m->cols);
     for (int i = 0; i < m->rows; i++) {
         printf("[ ");
         for (int j = 0; j < m->cols; j++) {
-            printf("%.4f ", m->data[i][j]);
+            printf("%.4f ", MATRIX_AT(m, i, j));
         }
         printf("]\n");
     }
@@ -160,8 +378,16 @@ void matrix_print(Matrix* m) {
 
 void matrix_map(Matrix* m, double (*func)(double)) {
     for (int i = 0; i < m->rows; i++) {
+        double* row = matrix_row(m, i);
         for (int j = 0; j < m->cols; j++) {
-            m->data[i][j] = func(m->data[i][j]);
+            row[j] = func(row[j]);
         }
     }
 }
+
+MatrixAllocStats matrix_alloc_stats(void) {
+    MatrixAllocStats stats;
+    stats.allocations = __atomic_load_n(&alloc_count, __ATOMIC_RELAXED);
+    stats.bytes = __atomic_load_n(&alloc_bytes, __ATOMIC_RELAXED);
+    return stats;
+}
@@ -5,21 +5,60 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 
+// Dense row-major matrix: element (i, j) is data[i * stride + j]. Matrices
+// from matrix_create have stride == cols; views into another matrix keep
+// the parent's stride.
 typedef struct {
     int rows;
     int cols;
-    double** data;
+    int stride;
+    double* data;
+    int owns_data;  // 0 for views and for memory owned elsewhere (matrix_wrap)
 } Matrix;
 
-// Matrix creation and destruction
+#define MATRIX_AT(m, i, j) ((m)->data[(size_t)(i) * (m)->stride + (j)])
+
+static inline double* matrix_row(const Matrix* m, int row) {
+    return m->data + (size_t)row * m->stride;
+}
+
+static inline int matrix_is_contiguous(const Matrix* m) {
+    return m->stride == m->cols || m->rows <= 1;
+}
+
+// Cumulative allocation counters, for instrumentation
+typedef struct {
+    unsigned long long allocations;
+    unsigned long long bytes;
+} MatrixAllocStats;
+
+// Matrix creation and destruction. matrix_create() returns zeroed storage
+// from the per-thread pool in matrix_pool.h; matrix_free() gives it back.
 Matrix* matrix_create(int rows, int cols);
 void matrix_free(Matrix* m);
 Matrix* matrix_copy(Matrix* m);
+// Matrix header over existing storage; matrix_free() releases only the header
+Matrix* matrix_wrap(double* data, int rows, int cols);
+
+// O(1) non-owning views, returned by value and never passed to
+// matrix_free. They share memory with the source and accept every
+// operation that takes a Matrix*. An invalid range prints an error and
+// gives an empty (0 x 0) view.
+Matrix matrix_view(const Matrix* m, int row, int col, int rows, int cols); // Sub-block
+Matrix matrix_slice_rows(const Matrix* m, int start, int count);
+Matrix matrix_slice_cols(const Matrix* m, int start, int count);
+// Reinterpret a contiguous matrix (or view) as rows x cols, same element order
+Matrix matrix_reshape(const Matrix* m, int rows, int cols);
 
 // Matrix initialization
 void matrix_fill(Matrix* m, double value);
-void matrix_randomize(Matrix* m, double min, double max);
+void matrix_randomize(Matrix* m, double min, double max); // Seeded from rand()
+// Uniform fill from a Philox stream; element (i, j) depends only on
+// (seed, stream, i * cols + j), so the result is identical whatever the
+// number of threads used to fill large matrices
+void matrix_randomize_seeded(Matrix* m, double min, double max, uint64_t seed, uint64_t stream);
 void matrix_set(Matrix* m, int row, int col, double value);
 double matrix_get(Matrix* m, int row, int col);
 
@@ -30,9 +69,17 @@ Matrix* matrix_multiply(Matrix* a, Matrix* b);
 Matrix* matrix_multiply_scalar(Matrix* m, double scalar);
 Matrix* matrix_transpose(Matrix* m);
 Matrix* matrix_hadamard(Matrix* a, Matrix* b); // Element-wise multiplication
+Matrix* matrix_add_column(Matrix* m, Matrix* column); // Adds a (rows x 1) column to every column of m
+Matrix* matrix_sum_columns(Matrix* m); // Row sums as a (rows x 1) column
+
+// In-place GEMM into preallocated storage: c = alpha * op(a) * op(b) + beta * c,
+// where op(x) is x or its transpose. Returns 1 on a shape mismatch.
+int matrix_gemm(Matrix* c, Matrix* a, int transpose_a, Matrix* b, int transpose_b,
+                double alpha, double beta);
 
 // Matrix utilities
 void matrix_print(Matrix* m);
 void matrix_map(Matrix* m, double (*func)(double));
+MatrixAllocStats matrix_alloc_stats(void);
 
 #endif
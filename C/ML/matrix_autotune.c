@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "gemm.h"
+#include "strassen.h"
+
+#define NUM_REPEATS 3
+// A candidate must beat the current best by this factor, so timing noise
+// does not walk the search away from a good configuration
+#define MIN_IMPROVEMENT 1.03
+
+typedef struct {
+    int m, k, n;
+} TuneShape;
+
+// A square product and the layer x batch shapes seen in training
+static const TuneShape shapes[] = {
+    { 384, 384, 384 },
+    { 256, 1024, 32 },
+    { 1024, 64, 256 },
+};
+#define NUM_SHAPES (int)(sizeof(shapes) / sizeof(shapes[0]))
+
+static const int kc_candidates[] = { 64, 128, 192, 256, 384, 512 };
+static const int mc_candidates[] = { 32, 64, 96, 128, 192, 256, 384, 512 };
+static const int nc_candidates[] = { 256, 512, 1024, 2048, 4096 };
+// Strassen cutoffs, timed on one STRASSEN_SIZE square product; a cutoff
+// of STRASSEN_SIZE runs the classical kernel
+#define STRASSEN_SIZE 1024
+static const int strassen_candidates[] = { 512, 256, 128 };
+
+static double min_seconds = 0.02;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Best GFLOP/s of a few timed runs of one shape
+static double measure_shape(const TuneShape* s, Matrix* a, Matrix* b, Matrix* c) {
+    double best = 0.0;
+    for (int r = 0; r < NUM_REPEATS; r++) {
+        int calls = 0;
+        double start = now_seconds();
+        double elapsed;
+        do {
+            matrix_gemm(c, a, 0, b, 0, 1.0, 0.0);
+            calls++;
+            elapsed = now_seconds() - start;
+        } while (elapsed < min_seconds);
+
+        double gflops = 2.0 * s->m * s->k * s->n * calls / elapsed * 1e-9;
+        if (gflops > best) best = gflops;
+    }
+    return best;
+}
+
+// Geometric mean of GFLOP/s over the tuning shapes
+static double score(const GemmConfig* config, Matrix** a, Matrix** b, Matrix** c) {
+    if (gemm_set_config(config)) return 0.0;
+    double log_sum = 0.0;
+    for (int i = 0; i < NUM_SHAPES; i++) {
+        log_sum += log(measure_shape(&shapes[i], a[i], b[i], c[i]));
+    }
+    return exp(log_sum / NUM_SHAPES);
+}
+
+static void print_config(const char* label, const GemmConfig* config, double gflops) {
+    printf("%-10s mc=%-4d kc=%-4d nc=%-5d mr=%d nr=%d threads=%-2d %8.3f GFLOP/s\n", label,
+           config->mc, config->kc, config->nc, config->mr, config->nr, config->threads, gflops);
+}
+
+// Try each value for one parameter with the others fixed; keep the best
+static double tune_parameter(const char* name, GemmConfig* best, double best_score, int* field,
+                             const int* candidates, int count, Matrix** a, Matrix** b, Matrix** c) {
+    int original = *field;
+    int best_value = original;
+    for (int i = 0; i < count; i++) {
+        if (candidates[i] == original) continue;
+        *field = candidates[i];
+        if (!gemm_config_valid(best)) continue;
+
+        double s = score(best, a, b, c);
+        print_config(name, best, s);
+        if (s > best_score * MIN_IMPROVEMENT) {
+            best_score = s;
+            best_value = candidates[i];
+        }
+    }
+    *field = best_value;
+    return best_score;
+}
+
+// Smallest cutoff that is faster than the larger ones on a square product
+static int tune_strassen_cutoff(const GemmConfig* config) {
+    gemm_set_config(config);
+    Matrix* a = matrix_create(STRASSEN_SIZE, STRASSEN_SIZE);
+    Matrix* b = matrix_create(STRASSEN_SIZE, STRASSEN_SIZE);
+    Matrix* c = matrix_create(STRASSEN_SIZE, STRASSEN_SIZE);
+    matrix_randomize_seeded(a, -1.0, 1.0, 3, 0);
+    matrix_randomize_seeded(b, -1.0, 1.0, 4, 0);
+    matrix_gemm(c, a, 0, b, 0, 1.0, 0.0);
+
+    int best_cutoff = STRASSEN_SIZE;
+    double best_seconds = 1e30;
+    for (int i = -1; i < (int)(sizeof(strassen_candidates) / sizeof(int)); i++) {
+        int cutoff = i < 0 ? STRASSEN_SIZE : strassen_candidates[i];
+        double seconds = 1e30;
+        for (int r = 0; r < NUM_REPEATS; r++) {
+            double start = now_seconds();
+            matrix_gemm_strassen(c, a, b, cutoff);
+            double elapsed = now_seconds() - start;
+            if (elapsed < seconds) seconds = elapsed;
+        }
+        printf("strassen   cutoff=%-4d %dx%d: %8.4f s\n", cutoff, STRASSEN_SIZE, STRASSEN_SIZE, seconds);
+        if (seconds * MIN_IMPROVEMENT < best_seconds) {
+            best_seconds = seconds;
+            best_cutoff = cutoff;
+        }
+    }
+
+    matrix_free(a);
+    matrix_free(b);
+    matrix_free(c);
+    return best_cutoff;
+}
+
+static void usage(const char* program) {
+    printf("Usage: %s [--quick] [--output FILE]\n", program);
+    printf("  --quick        shorter timings\n");
+    printf("  --output FILE  where to write the result (default $ML_GEMM_CONFIG or ~/.ml_gemm_config)\n");
+}
+
+int main(int argc, char** argv) {
+    const char* output = gemm_config_path();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            min_seconds = 0.005;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (output == NULL) {
+        fprintf(stderr, "Error: No output path; set HOME or ML_GEMM_CONFIG, or pass --output\n");
+        return 1;
+    }
+
+    printf("=== GEMM Auto-Tuner ===\n\n");
+    Matrix* a[NUM_SHAPES];
+    Matrix* b[NUM_SHAPES];
+    Matrix* c[NUM_SHAPES];
+    for (int i = 0; i < NUM_SHAPES; i++) {
+        a[i] = matrix_create(shapes[i].m, shapes[i].k);
+        b[i] = matrix_create(shapes[i].k, shapes[i].n);
+        c[i] = matrix_create(shapes[i].m, shapes[i].n);
+        matrix_randomize_seeded(a[i], -1.0, 1.0, 1, i);
+        matrix_randomize_seeded(b[i], -1.0, 1.0, 2, i);
+        printf("Shape %d: %dx%dx%d\n", i, shapes[i].m, shapes[i].k, shapes[i].n);
+    }
+    printf("\n");
+
+    // Start from the sysconf() heuristics, single-threaded while blocking
+    // is tuned so the block sizes reflect one core's caches
+    GemmConfig heuristic = gemm_default_config();
+    GemmConfig best = heuristic;
+    best.threads = 1;
+    double heuristic_score = score(&heuristic, a, b, c);
+    print_config("heuristic", &heuristic, heuristic_score);
+    double best_score = score(&best, a, b, c);
+
+    // Micro-kernel shape, rounding the block sizes to fit it
+    GemmConfig start = best;
+    for (int i = 0; i < gemm_num_micro_kernels; i++) {
+        GemmConfig candidate = start;
+        candidate.mr = gemm_micro_kernels[i].mr;
+        candidate.nr = gemm_micro_kernels[i].nr;
+        candidate.mc = candidate.mc / candidate.mr * candidate.mr;
+        candidate.nc = candidate.nc / candidate.nr * candidate.nr;
+        if (candidate.mr == start.mr && candidate.nr == start.nr) continue;
+
+        double s = score(&candidate, a, b, c);
+        print_config("micro", &candidate, s);
+        if (s > best_score * MIN_IMPROVEMENT) {
+            best_score = s;
+            best = candidate;
+        }
+    }
+
+    // Coordinate search over the block sizes, twice since they interact
+    for (int pass = 0; pass < 2; pass++) {
+        best_score = tune_parameter("kc", &best, best_score, &best.kc, kc_candidates,
+                                    sizeof(kc_candidates) / sizeof(int), a, b, c);
+        best_score = tune_parameter("mc", &best, best_score, &best.mc, mc_candidates,
+                                    sizeof(mc_candidates) / sizeof(int), a, b, c);
+        best_score = tune_parameter("nc", &best, best_score, &best.nc, nc_candidates,
+                                    sizeof(nc_candidates) / sizeof(int), a, b, c);
+    }
+
+    // Thread counts: powers of two up to the number of CPUs, and that number
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int thread_candidates[16];
+    int num_thread_candidates = 0;
+    for (int t = 2; t < cpus && num_thread_candidates < 15; t *= 2) thread_candidates[num_thread_candidates++] = t;
+    if (cpus > 1) thread_candidates[num_thread_candidates++] = (int)cpus;
+    best_score = tune_parameter("threads", &best, best_score, &best.threads, thread_candidates,
+                                num_thread_candidates, a, b, c);
+
+    best.strassen_cutoff = tune_strassen_cutoff(&best);
+    heuristic.strassen_cutoff = best.strassen_cutoff;
+
+    // Measure both again so the reported speedup is not a lucky sample
+    heuristic_score = score(&heuristic, a, b, c);
+    best_score = score(&best, a, b, c);
+    printf("\n");
+    print_config("heuristic", &heuristic, heuristic_score);
+    print_config("best", &best, best_score);
+    printf("Speedup over heuristics: %.2fx, Strassen cutoff %d\n\n", best_score / heuristic_score,
+           best.strassen_cutoff);
+    if (best_score < heuristic_score) {
+        printf("Keeping the heuristic configuration\n");
+        best = heuristic;
+    }
+
+    int status = gemm_config_save(output, &best);
+    if (status == 0) printf("Wrote %s\n", output);
+
+    for (int i = 0; i < NUM_SHAPES; i++) {
+        matrix_free(a[i]);
+        matrix_free(b[i]);
+        matrix_free(c[i]);
+    }
+    return status;
+}
@@ -0,0 +1,378 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "neural_network.h"
+#include "matrix_expr.h"
+#include "prune.h"
+#include "bf16.h"
+
+#define MAX_SAMPLES 15
+#define MIN_SAMPLE_SECONDS 0.005
+#define REGRESSION_THRESHOLD 0.10  // Flag results more than 10% slower than baseline
+#define MAX_BASELINE_ENTRIES 256
+#define BENCH_SPARSITY 0.9      // Pruned fraction for the block-sparse cases
+#define BENCH_BLOCK 4
+
+typedef enum {
+    OP_MULTIPLY,
+    OP_SPARSE_MULTIPLY,  // BSR weights pruned to BENCH_SPARSITY in 4x4 blocks
+    OP_BF16_MULTIPLY,    // bf16 operands, float accumulation
+    OP_ADD,
+    OP_TRANSPOSE,
+    OP_MAP,
+    OP_RANDOMIZE,
+    OP_CREATE_FREE,   // matrix_create + matrix_free of one shape (pooled)
+    OP_UPDATE,        // W - lr * dW with one temporary per operator
+    OP_UPDATE_FUSED,  // The same as a single in-place expression
+    OP_ACTIVATION
+} BenchOp;
+
+typedef struct {
+    const char* name;
+    BenchOp op;
+    int m, k, n;                  // Multiply: (m x k) * (k x n); others use m x n
+    ActivationType activation;
+} BenchCase;
+
+typedef struct {
+    char key[96];
+    double median;
+} BaselineEntry;
+
+static const BenchCase cases[] = {
+    // Square GEMM sweep
+    { "multiply", OP_MULTIPLY, 32, 32, 32, 0 },
+    { "multiply", OP_MULTIPLY, 64, 64, 64, 0 },
+    { "multiply", OP_MULTIPLY, 128, 128, 128, 0 },
+    { "multiply", OP_MULTIPLY, 256, 256, 256, 0 },
+    { "multiply", OP_MULTIPLY, 512, 512, 512, 0 },
+    // Shapes seen in training: matrix-vector, layer x batch, tall-skinny
+    { "multiply", OP_MULTIPLY, 512, 512, 1, 0 },
+    { "multiply", OP_MULTIPLY, 256, 1024, 32, 0 },
+    { "multiply", OP_MULTIPLY, 1024, 64, 256, 0 },
+    { "multiply", OP_MULTIPLY, 16, 4096, 16, 0 },
+    // Pruned layer inference: dense vs block-sparse weights, GEMV and batch
+    { "multiply", OP_MULTIPLY, 1024, 1024, 1, 0 },
+    { "bsr_multiply", OP_SPARSE_MULTIPLY, 1024, 1024, 1, 0 },
+    { "bf16_multiply", OP_BF16_MULTIPLY, 1024, 1024, 1, 0 },
+    { "multiply", OP_MULTIPLY, 1024, 1024, 32, 0 },
+    { "bsr_multiply", OP_SPARSE_MULTIPLY, 1024, 1024, 32, 0 },
+    { "bf16_multiply", OP_BF16_MULTIPLY, 1024, 1024, 32, 0 },
+    // Element-wise and memory-bound kernels
+    { "add", OP_ADD, 256, 0, 256, 0 },
+    { "add", OP_ADD, 1024, 0, 1024, 0 },
+    { "add", OP_ADD, 4096, 0, 1, 0 },
+    { "transpose", OP_TRANSPOSE, 256, 0, 256, 0 },
+    { "transpose", OP_TRANSPOSE, 1024, 0, 1024, 0 },
+    { "transpose", OP_TRANSPOSE, 4096, 0, 64, 0 },
+    { "map", OP_MAP, 1024, 0, 1024, 0 },
+    { "randomize", OP_RANDOMIZE, 1024, 0, 1024, 0 },
+    { "create_free", OP_CREATE_FREE, 64, 0, 32, 0 },
+    { "create_free", OP_CREATE_FREE, 256, 0, 256, 0 },
+    { "update", OP_UPDATE, 1024, 0, 1024, 0 },
+    { "update_expr", OP_UPDATE_FUSED, 1024, 0, 1024, 0 },
+    { "sigmoid", OP_ACTIVATION, 1024, 0, 256, ACTIVATION_SIGMOID },
+    { "tanh", OP_ACTIVATION, 1024, 0, 256, ACTIVATION_TANH },
+    { "relu", OP_ACTIVATION, 1024, 0, 256, ACTIVATION_RELU },
+    { "softmax", OP_ACTIVATION, 1024, 0, 256, ACTIVATION_SOFTMAX },
+};
+
+// Weights and result for OP_SPARSE_MULTIPLY, prepared by bench_case()
+static BsrMatrix* sparse_weights = NULL;
+static Matrix* sparse_out = NULL;
+// Operands for OP_BF16_MULTIPLY (result in sparse_out)
+static Bf16Matrix* bf16_weights = NULL;
+static Bf16Matrix* bf16_inputs = NULL;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double scale_by_two(double x) {
+    return 2.0 * x;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static int is_multiply(BenchOp op) {
+    return op == OP_MULTIPLY || op == OP_SPARSE_MULTIPLY || op == OP_BF16_MULTIPLY;
+}
+
+static void case_key(const BenchCase* c, char* key, size_t size) {
+    if (is_multiply(c->op)) {
+        snprintf(key, size, "%s,%dx%dx%d", c->name, c->m, c->k, c->n);
+    } else {
+        snprintf(key, size, "%s,%dx%d", c->name, c->m, c->n);
+    }
+}
+
+// Run the kernel once; results are freed outside the timed region
+static Matrix* run_case(const BenchCase* c, Matrix* a, Matrix* b) {
+    switch (c->op) {
+        case OP_MULTIPLY:  return matrix_multiply(a, b);
+        case OP_SPARSE_MULTIPLY: bsr_multiply(sparse_out, sparse_weights, b); return NULL;
+        case OP_BF16_MULTIPLY: bf16_multiply(sparse_out, bf16_weights, bf16_inputs); return NULL;
+        case OP_ADD:       return matrix_add(a, b);
+        case OP_TRANSPOSE: return matrix_transpose(a);
+        case OP_MAP:       matrix_map(a, scale_by_two); return NULL;
+        case OP_RANDOMIZE: matrix_randomize_seeded(a, -1.0, 1.0, 42, 0); return NULL;
+        case OP_CREATE_FREE: matrix_free(matrix_create(c->m, c->n)); return NULL;
+        case OP_UPDATE: {
+            Matrix* step = matrix_multiply_scalar(b, 1e-9);
+            Matrix* updated = matrix_subtract(a, step);
+            matrix_free(step);
+            return updated;
+        }
+        case OP_UPDATE_FUSED: {
+            MatrixExpr e = matrix_expr(a);
+            matrix_eval(a, expr_add_scaled(&e, b, -1e-9));
+            return NULL;
+        }
+        case OP_ACTIVATION:
+            apply_activation(a, c->activation);
+            return NULL;
+    }
+    return NULL;
+}
+
+// Nominal work per call: FLOPs (1 per element for element-wise kernels)
+// and the minimum bytes each kernel must read and write
+static void case_work(const BenchCase* c, double* flops, double* bytes) {
+    double elems = (double)c->m * c->n;
+    switch (c->op) {
+        case OP_MULTIPLY:
+            *flops = 2.0 * c->m * c->k * c->n;
+            *bytes = ((double)c->m * c->k + (double)c->k * c->n + elems) * sizeof(double);
+            break;
+        case OP_SPARSE_MULTIPLY:
+            // Only the kept blocks are read and multiplied
+            *flops = 2.0 * c->m * c->k * c->n * (1.0 - BENCH_SPARSITY);
+            *bytes = ((double)c->m * c->k * (1.0 - BENCH_SPARSITY) + (double)c->k * c->n + elems) * sizeof(double);
+            break;
+        case OP_BF16_MULTIPLY:
+            *flops = 2.0 * c->m * c->k * c->n;
+            *bytes = ((double)c->m * c->k + (double)c->k * c->n) * sizeof(bf16) + elems * sizeof(double);
+            break;
+        case OP_ADD:
+            *flops = elems;
+            *bytes = 3.0 * elems * sizeof(double);
+            break;
+        case OP_TRANSPOSE:
+            *flops = 0.0;
+            *bytes = 2.0 * elems * sizeof(double);
+            break;
+        case OP_RANDOMIZE:
+        case OP_CREATE_FREE:  // Zeroing the storage
+            *flops = 0.0;
+            *bytes = elems * sizeof(double);
+            break;
+        case OP_UPDATE:
+        case OP_UPDATE_FUSED:
+            *flops = 2.0 * elems;
+            *bytes = 3.0 * elems * sizeof(double);
+            break;
+        case OP_MAP:
+        case OP_ACTIVATION:
+            *flops = elems;
+            *bytes = 2.0 * elems * sizeof(double);
+            break;
+    }
+}
+
+// Median seconds per call over several samples, each long enough to time
+static double bench_case(const BenchCase* c, int num_samples) {
+    int multiply = is_multiply(c->op);
+    int a_cols = multiply ? c->k : c->n;
+    Matrix* a = matrix_create(c->m, a_cols);
+    Matrix* b = multiply ? matrix_create(c->k, c->n) : matrix_create(c->m, c->n);
+    matrix_randomize(a, -1.0, 1.0);
+    matrix_randomize(b, -1.0, 1.0);
+    if (c->op == OP_SPARSE_MULTIPLY) {
+        matrix_prune_blocks(a, BENCH_SPARSITY, BENCH_BLOCK, BENCH_BLOCK, NULL);
+        sparse_weights = bsr_from_dense(a, BENCH_BLOCK, BENCH_BLOCK);
+        sparse_out = matrix_create(c->m, c->n);
+    }
+    if (c->op == OP_BF16_MULTIPLY) {
+        bf16_weights = bf16_matrix_from(a);
+        bf16_inputs = bf16_matrix_from(b);
+        sparse_out = matrix_create(c->m, c->n);
+    }
+
+    // Calibrate the number of calls per sample
+    int iterations = 1;
+    for (;;) {
+        double start = now_seconds();
+        for (int i = 0; i < iterations; i++) matrix_free(run_case(c, a, b));
+        if (now_seconds() - start >= MIN_SAMPLE_SECONDS || iterations >= (1 << 16)) break;
+        iterations *= 2;
+    }
+
+    double samples[MAX_SAMPLES];
+    Matrix** results = (Matrix**)malloc(iterations * sizeof(Matrix*));
+    for (int s = 0; s < num_samples; s++) {
+        double start = now_seconds();
+        for (int i = 0; i < iterations; i++) results[i] = run_case(c, a, b);
+        samples[s] = (now_seconds() - start) / iterations;
+        for (int i = 0; i < iterations; i++) matrix_free(results[i]);
+
+        // Keep repeated in-place activations from drifting to inf/0
+        if (c->op == OP_MAP || c->op == OP_ACTIVATION) matrix_randomize(a, -1.0, 1.0);
+    }
+    free(results);
+
+    qsort(samples, num_samples, sizeof(double), compare_doubles);
+    if (c->op == OP_SPARSE_MULTIPLY) {
+        bsr_free(sparse_weights);
+        matrix_free(sparse_out);
+        sparse_weights = NULL;
+        sparse_out = NULL;
+    }
+    if (c->op == OP_BF16_MULTIPLY) {
+        bf16_matrix_free(bf16_weights);
+        bf16_matrix_free(bf16_inputs);
+        matrix_free(sparse_out);
+        bf16_weights = NULL;
+        bf16_inputs = NULL;
+        sparse_out = NULL;
+    }
+    matrix_free(a);
+    matrix_free(b);
+    return samples[num_samples / 2];
+}
+
+static int load_baseline(const char* path, BaselineEntry* entries) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), file) && count < MAX_BASELINE_ENTRIES) {
+        // kernel,shape,median_seconds,...
+        char* first = strchr(line, ',');
+        char* second = first ? strchr(first + 1, ',') : NULL;
+        if (!second || strncmp(line, "kernel,", 7) == 0) continue;
+
+        size_t key_len = second - line;
+        if (key_len >= sizeof(entries[count].key)) continue;
+        memcpy(entries[count].key, line, key_len);
+        entries[count].key[key_len] = '\0';
+        entries[count].median = atof(second + 1);
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+static const BaselineEntry* find_baseline(const BaselineEntry* entries, int count, const char* key) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].key, key) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+static void usage(const char* program) {
+    printf("Usage: %s [--quick] [--filter NAME] [--baseline FILE] [--save FILE]\n", program);
+    printf("  --quick          3 samples per case instead of %d\n", MAX_SAMPLES);
+    printf("  --filter NAME    Only run kernels whose name contains NAME\n");
+    printf("  --baseline FILE  Compare medians against a file written by --save\n");
+    printf("  --save FILE      Write results as the new baseline\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* baseline_path = NULL;
+    const char* save_path = NULL;
+    const char* filter = NULL;
+    int num_samples = MAX_SAMPLES;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            num_samples = 3;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    srand(12345);
+
+    BaselineEntry baseline[MAX_BASELINE_ENTRIES];
+    int baseline_count = 0;
+    if (baseline_path) {
+        baseline_count = load_baseline(baseline_path, baseline);
+        if (baseline_count < 0) {
+            printf("No baseline at '%s' (create one with --save)\n\n", baseline_path);
+            baseline_count = 0;
+        }
+    }
+
+    FILE* save = NULL;
+    if (save_path) {
+        save = fopen(save_path, "w");
+        if (!save) {
+            fprintf(stderr, "Error: Could not write baseline '%s'\n", save_path);
+            return 1;
+        }
+        fprintf(save, "kernel,shape,median_seconds,gflops_per_sec,gbytes_per_sec\n");
+    }
+
+    printf("=== Matrix Kernel Benchmark (median of %d samples) ===\n\n", num_samples);
+    printf("%-12s %-16s %14s %10s %10s %10s\n", "kernel", "shape", "median", "GFLOP/s", "GB/s", "vs base");
+
+    int regressions = 0;
+    int num_cases = sizeof(cases) / sizeof(cases[0]);
+    for (int i = 0; i < num_cases; i++) {
+        const BenchCase* c = &cases[i];
+        if (filter && !strstr(c->name, filter)) continue;
+
+        char key[96];
+        case_key(c, key, sizeof(key));
+
+        double median = bench_case(c, num_samples);
+        double flops = 0.0, bytes = 0.0;
+        case_work(c, &flops, &bytes);
+        double gflops = flops / median * 1e-9;
+        double gbytes = bytes / median * 1e-9;
+
+        char comparison[32] = "";
+        const BaselineEntry* base = find_baseline(baseline, baseline_count, key);
+        if (base && base->median > 0) {
+            double speedup = base->median / median;
+            int regressed = median > base->median * (1.0 + REGRESSION_THRESHOLD);
+            snprintf(comparison, sizeof(comparison), "%.2fx%s", speedup, regressed ? " !" : "");
+            regressions += regressed;
+        }
+
+        const char* shape = strchr(key, ',') + 1;
+        printf("%-12s %-16s %11.3f us %10.3f %10.3f %10s\n",
+               c->name, shape, median * 1e6, gflops, gbytes, comparison);
+
+        if (save) {
+            fprintf(save, "%s,%.9e,%.4f,%.4f\n", key, median, gflops, gbytes);
+        }
+    }
+
+    if (save) {
+        fclose(save);
+        printf("\nBaseline saved to '%s'\n", save_path);
+    }
+    if (baseline_count > 0) {
+        printf("\n%d kernel(s) more than %.0f%% slower than baseline (marked !)\n",
+               regressions, REGRESSION_THRESHOLD * 100);
+    }
+
+    return 0;
+}
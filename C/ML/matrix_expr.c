@@ -0,0 +1,135 @@
+#include "matrix_expr.h"
+
+// Elements evaluated per tile: small enough that the tile stays in L1
+// while every step of the chain runs over it
+#define EXPR_TILE 512
+
+MatrixExpr matrix_expr(const Matrix* source) {
+    MatrixExpr e;
+    e.source = source;
+    e.num_steps = 0;
+    return e;
+}
+
+static MatrixExpr* push(MatrixExpr* e, MatrixExprOp op, const Matrix* operand,
+                        double scalar, double (*func)(double)) {
+    if (e->num_steps < 0) return e;
+    if (e->num_steps == MATRIX_EXPR_MAX_OPS) {
+        fprintf(stderr, "Matrix expression longer than %d operations\n", MATRIX_EXPR_MAX_OPS);
+        e->num_steps = -1;  // Rejected by matrix_eval
+        return e;
+    }
+
+    MatrixExprStep* step = &e->steps[e->num_steps++];
+    step->op = op;
+    step->operand = operand;
+    step->scalar = scalar;
+    step->func = func;
+    return e;
+}
+
+MatrixExpr* expr_add(MatrixExpr* e, const Matrix* m) {
+    return push(e, EXPR_ADD, m, 0.0, NULL);
+}
+
+MatrixExpr* expr_sub(MatrixExpr* e, const Matrix* m) {
+    return push(e, EXPR_SUB, m, 0.0, NULL);
+}
+
+MatrixExpr* expr_mul(MatrixExpr* e, const Matrix* m) {
+    return push(e, EXPR_MUL, m, 0.0, NULL);
+}
+
+MatrixExpr* expr_add_scaled(MatrixExpr* e, const Matrix* m, double scale) {
+    return push(e, EXPR_ADD_SCALED, m, scale, NULL);
+}
+
+MatrixExpr* expr_mul_mapped(MatrixExpr* e, const Matrix* m, double (*func)(double)) {
+    return push(e, EXPR_MUL_MAPPED, m, 0.0, func);
+}
+
+MatrixExpr* expr_add_column(MatrixExpr* e, const Matrix* column) {
+    return push(e, EXPR_ADD_COLUMN, column, 0.0, NULL);
+}
+
+MatrixExpr* expr_scale(MatrixExpr* e, double scale) {
+    return push(e, EXPR_SCALE, NULL, scale, NULL);
+}
+
+MatrixExpr* expr_map(MatrixExpr* e, double (*func)(double)) {
+    return push(e, EXPR_MAP, NULL, 0.0, func);
+}
+
+static int check_shapes(const Matrix* dest, const MatrixExpr* e) {
+    if (e->num_steps < 0) return 1;
+    if (e->source->rows != dest->rows || e->source->cols != dest->cols) {
+        fprintf(stderr, "Expression source (%d,%d) does not match destination (%d,%d)\n",
+                e->source->rows, e->source->cols, dest->rows, dest->cols);
+        return 1;
+    }
+
+    for (int s = 0; s < e->num_steps; s++) {
+        const Matrix* m = e->steps[s].operand;
+        if (m == NULL) continue;
+        int cols = e->steps[s].op == EXPR_ADD_COLUMN ? 1 : dest->cols;
+        if (m->rows != dest->rows || m->cols != cols) {
+            fprintf(stderr, "Expression operand %d is (%d,%d), expected (%d,%d)\n",
+                    s, m->rows, m->cols, dest->rows, cols);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int matrix_eval(Matrix* dest, const MatrixExpr* e) {
+    if (check_shapes(dest, e)) return 1;
+
+    double tile[EXPR_TILE];
+    for (int i = 0; i < dest->rows; i++) {
+        for (int j0 = 0; j0 < dest->cols; j0 += EXPR_TILE) {
+            int n = dest->cols - j0 < EXPR_TILE ? dest->cols - j0 : EXPR_TILE;
+
+            const double* src = matrix_row(e->source, i) + j0;
+            for (int k = 0; k < n; k++) tile[k] = src[k];
+
+            for (int s = 0; s < e->num_steps; s++) {
+                const MatrixExprStep* step = &e->steps[s];
+                const double* m = step->operand && step->op != EXPR_ADD_COLUMN
+                                  ? matrix_row(step->operand, i) + j0 : NULL;
+                double scalar = step->scalar;
+
+                switch (step->op) {
+                    case EXPR_ADD:
+                        for (int k = 0; k < n; k++) tile[k] += m[k];
+                        break;
+                    case EXPR_SUB:
+                        for (int k = 0; k < n; k++) tile[k] -= m[k];
+                        break;
+                    case EXPR_MUL:
+                        for (int k = 0; k < n; k++) tile[k] *= m[k];
+                        break;
+                    case EXPR_ADD_SCALED:
+                        for (int k = 0; k < n; k++) tile[k] += scalar * m[k];
+                        break;
+                    case EXPR_MUL_MAPPED:
+                        for (int k = 0; k < n; k++) tile[k] *= step->func(m[k]);
+                        break;
+                    case EXPR_ADD_COLUMN:
+                        scalar = MATRIX_AT(step->operand, i, 0);
+                        for (int k = 0; k < n; k++) tile[k] += scalar;
+                        break;
+                    case EXPR_SCALE:
+                        for (int k = 0; k < n; k++) tile[k] *= scalar;
+                        break;
+                    case EXPR_MAP:
+                        for (int k = 0; k < n; k++) tile[k] = step->func(tile[k]);
+                        break;
+                }
+            }
+
+            double* out = matrix_row(dest, i) + j0;
+            for (int k = 0; k < n; k++) out[k] = tile[k];
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef MATRIX_EXPR_H
+#define MATRIX_EXPR_H
+
+#include "matrix.h"
+
+#define MATRIX_EXPR_MAX_OPS 8
+
+typedef enum {
+    EXPR_ADD,          // acc += M
+    EXPR_SUB,          // acc -= M
+    EXPR_MUL,          // acc .*= M (Hadamard)
+    EXPR_ADD_SCALED,   // acc += s * M
+    EXPR_MUL_MAPPED,   // acc .*= f(M), e.g. an activation derivative
+    EXPR_ADD_COLUMN,   // acc += column, broadcast over the columns
+    EXPR_SCALE,        // acc *= s
+    EXPR_MAP           // acc = f(acc)
+} MatrixExprOp;
+
+typedef struct {
+    MatrixExprOp op;
+    const Matrix* operand;
+    double scalar;
+    double (*func)(double);
+} MatrixExprStep;
+
+// A recorded chain of element-wise operations applied to a source matrix.
+// Nothing is computed until matrix_eval(), which runs the whole chain in
+// one pass over the destination, a cache-sized tile at a time, so each
+// element is loaded and stored once instead of once per operator and no
+// temporaries are allocated. The expression lives on the stack:
+//
+//     MatrixExpr e = matrix_expr(weights);
+//     expr_add_scaled(&e, dW, -learning_rate);
+//     matrix_eval(weights, &e);               // weights -= lr * dW
+typedef struct {
+    const Matrix* source;
+    int num_steps;
+    MatrixExprStep steps[MATRIX_EXPR_MAX_OPS];
+} MatrixExpr;
+
+MatrixExpr matrix_expr(const Matrix* source);
+
+// Recording; each returns the expression so calls can be nested
+MatrixExpr* expr_add(MatrixExpr* e, const Matrix* m);
+MatrixExpr* expr_sub(MatrixExpr* e, const Matrix* m);
+MatrixExpr* expr_mul(MatrixExpr* e, const Matrix* m);
+MatrixExpr* expr_add_scaled(MatrixExpr* e, const Matrix* m, double scale);
+MatrixExpr* expr_mul_mapped(MatrixExpr* e, const Matrix* m, double (*func)(double));
+MatrixExpr* expr_add_column(MatrixExpr* e, const Matrix* column);
+MatrixExpr* expr_scale(MatrixExpr* e, double scale);
+MatrixExpr* expr_map(MatrixExpr* e, double (*func)(double));
+
+// Evaluate into dest, which may be the source or any operand (updates in
+// place are safe). Returns 1 on a shape mismatch or overlong chain.
+int matrix_eval(Matrix* dest, const MatrixExpr* e);
+
+#endif
@@ -0,0 +1,202 @@
+#include "matrix_pool.h"
+#include <pthread.h>
+
+#define POOL_NUM_CLASSES 17   // MIN_ELEMENTS << 16 == MAX_ELEMENTS
+#define POOL_DATA_OFFSET 64   // Data starts one cache line into the block
+#define POOL_UNPOOLED (-1)
+
+// Header of every block allocated by matrix_create(); the Matrix comes
+// first, so the block address is the Matrix pointer
+typedef struct PoolBlock {
+    Matrix matrix;
+    int size_class;          // POOL_UNPOOLED for oversized blocks
+    struct PoolBlock* next;  // Free list link while cached
+} PoolBlock;
+
+_Static_assert(sizeof(PoolBlock) <= POOL_DATA_OFFSET, "PoolBlock must fit before the data");
+
+typedef struct {
+    PoolBlock* free_list[POOL_NUM_CLASSES];
+    size_t bytes;
+    int registered;  // Exit destructor installed for this thread
+    int exited;      // Destructor ran; later frees go to the shared lists
+} ThreadCache;
+
+static __thread ThreadCache thread_cache;
+
+static PoolBlock* global_list[POOL_NUM_CLASSES];
+static size_t global_bytes = 0;
+static pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t exit_key;
+static pthread_once_t exit_key_once = PTHREAD_ONCE_INIT;
+
+static int pool_enabled = 1;
+static unsigned long long stat_hits = 0;
+static unsigned long long stat_global_hits = 0;
+static unsigned long long stat_misses = 0;
+static unsigned long long stat_bytes_retained = 0;
+
+static int size_class(size_t elements) {
+    if (elements > MATRIX_POOL_MAX_ELEMENTS) return POOL_UNPOOLED;
+    int c = 0;
+    while (((size_t)MATRIX_POOL_MIN_ELEMENTS << c) < elements) c++;
+    return c;
+}
+
+static size_t class_bytes(int c) {
+    return POOL_DATA_OFFSET + ((size_t)MATRIX_POOL_MIN_ELEMENTS << c) * sizeof(double);
+}
+
+// Push onto the shared list if it has room, else free; takes the lock
+static void give_global(PoolBlock* block) {
+    size_t bytes = class_bytes(block->size_class);
+    pthread_mutex_lock(&global_lock);
+    if (global_bytes + bytes <= MATRIX_POOL_GLOBAL_BYTES) {
+        block->next = global_list[block->size_class];
+        global_list[block->size_class] = block;
+        global_bytes += bytes;
+        block = NULL;
+    }
+    pthread_mutex_unlock(&global_lock);
+
+    if (block) {
+        __atomic_fetch_sub(&stat_bytes_retained, bytes, __ATOMIC_RELAXED);
+        free(block);
+    }
+}
+
+// Hand an exiting thread's blocks to the other threads. Destructors of
+// other keys may still free matrices after this, so mark the cache to
+// keep them from being stranded on a thread that is going away.
+static void flush_thread_cache(void* arg) {
+    ThreadCache* cache = (ThreadCache*)arg;
+    cache->exited = 1;
+    for (int c = 0; c < POOL_NUM_CLASSES; c++) {
+        while (cache->free_list[c]) {
+            PoolBlock* block = cache->free_list[c];
+            cache->free_list[c] = block->next;
+            give_global(block);
+        }
+    }
+    cache->bytes = 0;
+}
+
+static void create_exit_key(void) {
+    pthread_key_create(&exit_key, flush_thread_cache);
+}
+
+static void register_thread(void) {
+    pthread_once(&exit_key_once, create_exit_key);
+    pthread_setspecific(exit_key, &thread_cache);
+    thread_cache.registered = 1;
+}
+
+static PoolBlock* allocate_block(int c, size_t elements) {
+    // aligned_alloc needs a multiple of the alignment
+    size_t bytes = c == POOL_UNPOOLED
+        ? (POOL_DATA_OFFSET + elements * sizeof(double) + POOL_DATA_OFFSET - 1) / POOL_DATA_OFFSET * POOL_DATA_OFFSET
+        : class_bytes(c);
+    PoolBlock* block = (PoolBlock*)aligned_alloc(POOL_DATA_OFFSET, bytes);
+    block->size_class = c;
+    block->next = NULL;
+    return block;
+}
+
+Matrix* matrix_pool_take(size_t elements) {
+    int c = size_class(elements);
+    PoolBlock* block = NULL;
+
+    if (c != POOL_UNPOOLED && __atomic_load_n(&pool_enabled, __ATOMIC_RELAXED)) {
+        ThreadCache* cache = &thread_cache;
+        if (cache->free_list[c]) {
+            block = cache->free_list[c];
+            cache->free_list[c] = block->next;
+            cache->bytes -= class_bytes(c);
+            __atomic_fetch_add(&stat_hits, 1, __ATOMIC_RELAXED);
+        } else if (__atomic_load_n(&global_list[c], __ATOMIC_RELAXED)) {  // Rechecked under the lock
+            pthread_mutex_lock(&global_lock);
+            block = global_list[c];
+            if (block) {
+                global_list[c] = block->next;
+                global_bytes -= class_bytes(c);
+            }
+            pthread_mutex_unlock(&global_lock);
+            if (block) __atomic_fetch_add(&stat_global_hits, 1, __ATOMIC_RELAXED);
+        }
+        if (block) __atomic_fetch_sub(&stat_bytes_retained, class_bytes(c), __ATOMIC_RELAXED);
+    }
+
+    if (block == NULL) {
+        block = allocate_block(c, elements);
+        __atomic_fetch_add(&stat_misses, 1, __ATOMIC_RELAXED);
+    }
+    block->matrix.data = (double*)((char*)block + POOL_DATA_OFFSET);
+    return &block->matrix;
+}
+
+void matrix_pool_give(Matrix* m) {
+    PoolBlock* block = (PoolBlock*)m;
+    int c = block->size_class;
+    if (c == POOL_UNPOOLED || !__atomic_load_n(&pool_enabled, __ATOMIC_RELAXED)) {
+        free(block);
+        return;
+    }
+
+    size_t bytes = class_bytes(c);
+    __atomic_fetch_add(&stat_bytes_retained, bytes, __ATOMIC_RELAXED);
+    ThreadCache* cache = &thread_cache;
+    if (cache->exited || cache->bytes + bytes > MATRIX_POOL_THREAD_BYTES) {
+        give_global(block);
+        return;
+    }
+    if (!cache->registered) register_thread();
+    block->next = cache->free_list[c];
+    cache->free_list[c] = block;
+    cache->bytes += bytes;
+}
+
+MatrixPoolStats matrix_pool_stats(void) {
+    MatrixPoolStats stats;
+    stats.hits = __atomic_load_n(&stat_hits, __ATOMIC_RELAXED);
+    stats.global_hits = __atomic_load_n(&stat_global_hits, __ATOMIC_RELAXED);
+    stats.misses = __atomic_load_n(&stat_misses, __ATOMIC_RELAXED);
+    stats.bytes_retained = __atomic_load_n(&stat_bytes_retained, __ATOMIC_RELAXED);
+    return stats;
+}
+
+double matrix_pool_hit_rate(const MatrixPoolStats* stats) {
+    unsigned long long hits = stats->hits + stats->global_hits;
+    unsigned long long total = hits + stats->misses;
+    return total ? (double)hits / total : 0.0;
+}
+
+void matrix_pool_trim(void) {
+    ThreadCache* cache = &thread_cache;
+    size_t released = cache->bytes;
+    for (int c = 0; c < POOL_NUM_CLASSES; c++) {
+        while (cache->free_list[c]) {
+            PoolBlock* block = cache->free_list[c];
+            cache->free_list[c] = block->next;
+            free(block);
+        }
+    }
+    cache->bytes = 0;
+
+    pthread_mutex_lock(&global_lock);
+    for (int c = 0; c < POOL_NUM_CLASSES; c++) {
+        while (global_list[c]) {
+            PoolBlock* block = global_list[c];
+            global_list[c] = block->next;
+            free(block);
+        }
+    }
+    released += global_bytes;
+    global_bytes = 0;
+    pthread_mutex_unlock(&global_lock);
+
+    __atomic_fetch_sub(&stat_bytes_retained, released, __ATOMIC_RELAXED);
+}
+
+void matrix_pool_set_enabled(int enabled) {
+    __atomic_store_n(&pool_enabled, enabled, __ATOMIC_RELAXED);
+}
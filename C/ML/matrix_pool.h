@@ -0,0 +1,42 @@
+#ifndef MATRIX_POOL_H
+#define MATRIX_POOL_H
+
+#include "matrix.h"
+
+// Free lists behind matrix_create()/matrix_free(). A matrix is one block
+// holding its header and data; freed blocks are kept by capacity class
+// (powers of two from MATRIX_POOL_MIN_ELEMENTS up to
+// MATRIX_POOL_MAX_ELEMENTS doubles) and handed out again for any shape
+// of up to that many elements, so repeated create/free of the same few
+// shapes stops calling malloc. Each thread caches up to
+// MATRIX_POOL_THREAD_BYTES without locking; beyond that, and when a
+// thread exits, blocks go to a shared list capped at
+// MATRIX_POOL_GLOBAL_BYTES, and the rest are returned to the system.
+// Larger matrices bypass the pool.
+#define MATRIX_POOL_MIN_ELEMENTS 16
+#define MATRIX_POOL_MAX_ELEMENTS (1 << 20)
+#define MATRIX_POOL_THREAD_BYTES (16u << 20)
+#define MATRIX_POOL_GLOBAL_BYTES (64u << 20)
+
+typedef struct {
+    unsigned long long hits;         // Served from a thread cache
+    unsigned long long global_hits;  // Served from the shared list
+    unsigned long long misses;       // Newly allocated (including oversized)
+    unsigned long long bytes_retained;  // Held in all caches right now
+} MatrixPoolStats;
+
+MatrixPoolStats matrix_pool_stats(void);
+// Fraction of creates served without malloc, 0 before the first create
+double matrix_pool_hit_rate(const MatrixPoolStats* stats);
+// Release the calling thread's cache and the shared list to the system
+void matrix_pool_trim(void);
+// 0 makes every create allocate and every free release (for comparison);
+// cached blocks are kept until matrix_pool_trim()
+void matrix_pool_set_enabled(int enabled);
+
+// Used by matrix_create()/matrix_free(): a header whose data holds at
+// least `elements` doubles (not zeroed), and its release
+Matrix* matrix_pool_take(size_t elements);
+void matrix_pool_give(Matrix* m);
+
+#endif
@@ -1,4 +1,10 @@
 #include "neural_network.h"
+#include "matrix_expr.h"
+#include "plan.h"
+#include "checkpoint.h"
+#include "evaluate.h"
+#include "conv1d.h"
+#include "rng.h"
 #include <math.h>
 
 // Activation functions
@@ -36,6 +42,70 @@ double linear_derivative(double x) {
     return 1.0;
 }
 
+void softmax_columns(Matrix* m) {
+    double* col_max = (double*)malloc(m->cols * sizeof(double));
+    double* col_sum = (double*)calloc(m->cols, sizeof(double));
+
+    // Work row by row with one accumulator per column, so the inner loops
+    // run over contiguous memory
+    for (int j = 0; j < m->cols; j++) col_max[j] = MATRIX_AT(m, 0, j);
+    for (int i = 1; i < m->rows; i++) {
+        for (int j = 0; j < m->cols; j++) {
+            col_max[j] = MATRIX_AT(m, i, j) > col_max[j] ? MATRIX_AT(m, i, j) : col_max[j];
+        }
+    }
+    for (int i = 0; i < m->rows; i++) {
+        for (int j = 0; j < m->cols; j++) {
+            MATRIX_AT(m, i, j) = exp(MATRIX_AT(m, i, j) - col_max[j]);
+            col_sum[j] += MATRIX_AT(m, i, j);
+        }
+    }
+    for (int j = 0; j < m->cols; j++) col_sum[j] = 1.0 / col_sum[j];
+    for (int i = 0; i < m->rows; i++) {
+        for (int j = 0; j < m->cols; j++) {
+            MATRIX_AT(m, i, j) *= col_sum[j];
+        }
+    }
+
+    free(col_max);
+    free(col_sum);
+}
+
+ScalarFunction activation_function(ActivationType type) {
+    switch (type) {
+        case ACTIVATION_SIGMOID: return sigmoid;
+        case ACTIVATION_TANH:    return tanh_activation;
+        case ACTIVATION_RELU:    return relu;
+        default:                 return NULL;
+    }
+}
+
+ScalarFunction activation_derivative_function(ActivationType type) {
+    switch (type) {
+        case ACTIVATION_SIGMOID: return sigmoid_derivative;
+        case ACTIVATION_TANH:    return tanh_derivative;
+        case ACTIVATION_RELU:    return relu_derivative;
+        default:                 return NULL;
+    }
+}
+
+void activation_forward(Matrix* a, Matrix* z, ActivationType type) {
+    MatrixExpr e = matrix_expr(z);
+    ScalarFunction f = activation_function(type);
+    if (f) expr_map(&e, f);
+    matrix_eval(a, &e);
+    if (type == ACTIVATION_SOFTMAX) softmax_columns(a);
+}
+
+void multiply_activation_derivative(Matrix* delta, Matrix* z, ActivationType type) {
+    ScalarFunction derivative = activation_derivative_function(type);
+    if (derivative == NULL) return;
+
+    MatrixExpr e = matrix_expr(delta);
+    expr_mul_mapped(&e, z, derivative);
+    matrix_eval(delta, &e);
+}
+
 // Apply activation functions to matrices
 void apply_activation(Matrix* m, ActivationType type) {
     switch(type) {
@@ -51,6 +121,9 @@ void apply_activation(Matrix* m, ActivationType type) {
         case ACTIVATION_LINEAR:
             matrix_map(m, linear);
             break;
+        case ACTIVATION_SOFTMAX:
+            softmax_columns(m);
+            break;
     }
 }
 
@@ -68,24 +141,40 @@ void apply_activation_derivative(Matrix* m, ActivationType type) {
         case ACTIVATION_LINEAR:
             matrix_map(m, linear_derivative);
             break;
+        case ACTIVATION_SOFTMAX:
+            // Folded into the cross-entropy gradient of the output layer
+            matrix_fill(m, 1.0);
+            break;
     }
 }
 
 // Layer operations
-Layer* layer_create(int input_size, int output_size, ActivationType activation) {
+static void layer_init_weights(Layer* layer, uint64_t seed, uint64_t stream) {
+    if (layer->type == LAYER_EMBEDDING) {
+        double limit = 1.0 / sqrt(layer->output_size);
+        matrix_randomize_seeded(layer->weights, -limit, limit, seed, stream);
+        return;
+    }
+
+    // Xavier/He initialization; a filter's fan-in is channels * kernel_size
+    double limit = sqrt(2.0 / layer->weights->cols);
+    matrix_randomize_seeded(layer->weights, -limit, limit, seed, stream);
+    matrix_fill(layer->biases, 0.0);
+}
+
+// Allocates the parameters; weights are filled by layer_init_weights()
+static Layer* dense_layer_alloc(int input_size, int output_size, ActivationType activation) {
     Layer* layer = (Layer*)malloc(sizeof(Layer));
+    layer->type = LAYER_DENSE;
+    layer->pooling = POOLING_SUM;
+    memset(&layer->conv, 0, sizeof(layer->conv));
     layer->input_size = input_size;
     layer->output_size = output_size;
     layer->activation = activation;
 
-    // Initialize weights and biases
     layer->weights = matrix_create(output_size, input_size);
     layer->biases = matrix_create(output_size, 1);
-
-    // Xavier/He initialization
-    double limit = sqrt(2.0 / input_size);
-    matrix_randomize(layer->weights, -limit, limit);
-    matrix_fill(layer->biases, 0.0);
+    layer->mask = NULL;
 
     // Initialize cache
     layer->input = NULL;
@@ -94,42 +183,196 @@ Layer* layer_create(int input_size, int output_size, ActivationType activation)
     layer->dW = NULL;
     layer->db = NULL;
     layer->delta = NULL;
+    layer->columns = NULL;
+    layer->conv_out = NULL;
+
+    return layer;
+}
+
+Layer* layer_create(int input_size, int output_size, ActivationType activation) {
+    Layer* layer = dense_layer_alloc(input_size, output_size, activation);
+    layer_init_weights(layer, rng_seed_from_rand(), 0);
+    return layer;
+}
+
+static Layer* embedding_layer_alloc(int vocab_size, int embedding_dim, PoolingType pooling) {
+    Layer* layer = (Layer*)malloc(sizeof(Layer));
+    layer->type = LAYER_EMBEDDING;
+    layer->pooling = pooling;
+    memset(&layer->conv, 0, sizeof(layer->conv));
+    layer->input_size = vocab_size;
+    layer->output_size = embedding_dim;
+    layer->activation = ACTIVATION_LINEAR;
+
+    // One row per token; the following dense layer supplies the bias
+    layer->weights = matrix_create(vocab_size, embedding_dim);
+    layer->biases = NULL;
+    layer->mask = NULL;
+
+    layer->input = NULL;
+    layer->z = NULL;
+    layer->a = NULL;
+    layer->dW = NULL;
+    layer->db = NULL;
+    layer->delta = NULL;
+    layer->columns = NULL;
+    layer->conv_out = NULL;
+
+    return layer;
+}
+
+Layer* embedding_layer_create(int vocab_size, int embedding_dim, PoolingType pooling) {
+    Layer* layer = embedding_layer_alloc(vocab_size, embedding_dim, pooling);
+    layer_init_weights(layer, rng_seed_from_rand(), 0);
+    return layer;
+}
+
+static Layer* conv1d_layer_alloc(int channels, int length, int kernel_size, int filters,
+                                 int pool_size, PoolingType pooling, ActivationType activation) {
+    Conv1DShape shape;
+    if (conv1d_shape_init(&shape, channels, length, kernel_size, filters, pool_size)) {
+        fprintf(stderr, "Error: Invalid convolution: %d channels x %d positions, kernel %d, pool %d\n",
+                channels, length, kernel_size, pool_size);
+        return NULL;
+    }
+    if (pooling == POOLING_SUM) {
+        fprintf(stderr, "Error: Convolution layers pool with POOLING_MAX or POOLING_MEAN\n");
+        return NULL;
+    }
+
+    Layer* layer = (Layer*)malloc(sizeof(Layer));
+    layer->type = LAYER_CONV1D;
+    layer->pooling = pooling;
+    layer->conv = shape;
+    layer->input_size = channels * length;
+    layer->output_size = filters * shape.pooled_length;
+    layer->activation = activation;
+
+    // Weights are shared across positions: one row of taps per filter
+    layer->weights = matrix_create(filters, channels * kernel_size);
+    layer->biases = matrix_create(filters, 1);
+    layer->mask = NULL;
+
+    layer->input = NULL;
+    layer->z = NULL;
+    layer->a = NULL;
+    layer->dW = NULL;
+    layer->db = NULL;
+    layer->delta = NULL;
+    layer->columns = NULL;
+    layer->conv_out = NULL;
+
+    return layer;
+}
 
+Layer* conv1d_layer_create(int channels, int length, int kernel_size, int filters,
+                           int pool_size, PoolingType pooling, ActivationType activation) {
+    Layer* layer = conv1d_layer_alloc(channels, length, kernel_size, filters, pool_size, pooling, activation);
+    if (layer) layer_init_weights(layer, rng_seed_from_rand(), 0);
     return layer;
 }
 
 void layer_free(Layer* layer) {
     if (layer == NULL) return;
     matrix_free(layer->weights);
-    matrix_free(layer->biases);
+    if (layer->biases) matrix_free(layer->biases);
+    if (layer->mask) matrix_free(layer->mask);
     if (layer->input) matrix_free(layer->input);
     if (layer->z) matrix_free(layer->z);
     if (layer->a) matrix_free(layer->a);
     if (layer->dW) matrix_free(layer->dW);
     if (layer->db) matrix_free(layer->db);
     if (layer->delta) matrix_free(layer->delta);
+    if (layer->columns) matrix_free(layer->columns);
+    if (layer->conv_out) matrix_free(layer->conv_out);
     free(layer);
 }
 
-Matrix* layer_forward(Layer* layer, Matrix* input) {
-    // Save input for backpropagation
-    if (layer->input) matrix_free(layer->input);
-    layer->input = matrix_copy(input);
+// Number of valid token ids in column j; ids outside the vocabulary
+// (including the -1 padding) are skipped
+static int token_count(Layer* layer, Matrix* ids, int j) {
+    int count = 0;
+    for (int t = 0; t < ids->rows; t++) {
+        int id = (int)MATRIX_AT(ids, t, j);
+        if (id >= 0 && id < layer->input_size) count++;
+    }
+    return count;
+}
 
-    // z = W * x + b
-    Matrix* wx = matrix_multiply(layer->weights, input);
+// Gather and pool the embedding rows of each column's tokens. Cost is
+// proportional to the number of tokens, not the vocabulary size.
+static void embedding_pool_into(const Layer* layer, const Matrix* ids, Matrix* pooled) {
+    matrix_fill(pooled, 0.0);
+    for (int j = 0; j < ids->cols; j++) {
+        int count = 0;
+        for (int t = 0; t < ids->rows; t++) {
+            int id = (int)MATRIX_AT(ids, t, j);
+            if (id < 0 || id >= layer->input_size) continue;
+
+            double* row = matrix_row(layer->weights, id);
+            for (int d = 0; d < layer->output_size; d++) {
+                MATRIX_AT(pooled, d, j) += row[d];
+            }
+            count++;
+        }
+
+        if (layer->pooling == POOLING_MEAN && count > 1) {
+            for (int d = 0; d < layer->output_size; d++) {
+                MATRIX_AT(pooled, d, j) /= count;
+            }
+        }
+    }
+}
+
+static Matrix* embedding_pool(Layer* layer, Matrix* ids) {
+    Matrix* pooled = matrix_create(layer->output_size, ids->cols);
+    embedding_pool_into(layer, ids, pooled);
+    return pooled;
+}
+
+// z and a from the cached layer->input
+static void layer_compute(Layer* layer) {
+    Matrix* input = layer->input;
     if (layer->z) matrix_free(layer->z);
-    layer->z = matrix_add(wx, layer->biases);
-    matrix_free(wx);
+    if (layer->type == LAYER_EMBEDDING) {
+        layer->z = embedding_pool(layer, input);
+    } else if (layer->type == LAYER_CONV1D) {
+        layer->z = matrix_create(layer->output_size, input->cols);
+        conv1d_forward(layer, input, layer->z);
+    } else {
+        // z = W * x + b (x may hold a batch of column vectors)
+        layer->z = matrix_multiply(layer->weights, input);
+        MatrixExpr bias = matrix_expr(layer->z);
+        matrix_eval(layer->z, expr_add_column(&bias, layer->biases));
+    }
 
     // a = activation(z)
     if (layer->a) matrix_free(layer->a);
-    layer->a = matrix_copy(layer->z);
-    apply_activation(layer->a, layer->activation);
+    layer->a = matrix_create(layer->z->rows, layer->z->cols);
+    activation_forward(layer->a, layer->z, layer->activation);
+}
 
+Matrix* layer_forward(Layer* layer, Matrix* input) {
+    // Save input for backpropagation
+    if (layer->input) matrix_free(layer->input);
+    layer->input = matrix_copy(input);
+    layer_compute(layer);
     return layer->a;
 }
 
+void layer_infer(const Layer* layer, const Matrix* input, Matrix* output) {
+    if (layer->type == LAYER_EMBEDDING) {
+        embedding_pool_into(layer, input, output);
+    } else if (layer->type == LAYER_CONV1D) {
+        conv1d_infer(layer, input, output);
+    } else {
+        matrix_gemm(output, layer->weights, 0, (Matrix*)input, 0, 1.0, 0.0);
+        MatrixExpr bias = matrix_expr(output);
+        matrix_eval(output, expr_add_column(&bias, layer->biases));
+    }
+    activation_forward(output, output, layer->activation);
+}
+
 // Neural Network operations
 NeuralNetwork* nn_create(int num_layers) {
     NeuralNetwork* nn = (NeuralNetwork*)malloc(sizeof(NeuralNetwork));
@@ -139,6 +382,13 @@ NeuralNetwork* nn_create(int num_layers) {
         nn->layers[i] = NULL;
     }
     nn->learning_rate = 0.01;
+    nn->seed = rng_seed_from_rand();
+    nn->profiler = NULL;
+    nn->plan = NULL;
+    nn->checkpointer = NULL;
+    nn->early_stopping = NULL;
+    nn->recompute_interval = 0;
+    memset(&nn->activation_stats, 0, sizeof(ActivationStats));
     return nn;
 }
 
@@ -148,71 +398,330 @@ void nn_free(NeuralNetwork* nn) {
         layer_free(nn->layers[i]);
     }
     free(nn->layers);
+    plan_free(nn->plan);
     free(nn);
 }
 
 void nn_add_layer(NeuralNetwork* nn, int index, int input_size, int output_size, ActivationType activation) {
     if (index >= 0 && index < nn->num_layers) {
-        nn->layers[index] = layer_create(input_size, output_size, activation);
+        // Its gradient is only implemented fused with the cross-entropy loss
+        if (activation == ACTIVATION_SOFTMAX && index != nn->num_layers - 1) {
+            fprintf(stderr, "Error: Softmax is only supported on the output layer\n");
+            return;
+        }
+
+        // A compiled plan no longer matches the network
+        plan_free(nn->plan);
+        nn->plan = NULL;
+        nn->layers[index] = dense_layer_alloc(input_size, output_size, activation);
+        layer_init_weights(nn->layers[index], nn->seed, index);
+    }
+}
+
+void nn_add_embedding_layer(NeuralNetwork* nn, int index, int vocab_size, int embedding_dim, PoolingType pooling) {
+    if (index != 0) {
+        fprintf(stderr, "Error: An embedding layer takes token ids and must be the first layer\n");
+        return;
+    }
+    if (pooling == POOLING_MAX) {
+        fprintf(stderr, "Error: Embedding layers pool with POOLING_SUM or POOLING_MEAN\n");
+        return;
+    }
+    plan_free(nn->plan);
+    nn->plan = NULL;
+    nn->layers[index] = embedding_layer_alloc(vocab_size, embedding_dim, pooling);
+    layer_init_weights(nn->layers[index], nn->seed, index);
+}
+
+void nn_add_conv1d_layer(NeuralNetwork* nn, int index, int channels, int length, int kernel_size,
+                         int filters, int pool_size, PoolingType pooling, ActivationType activation) {
+    if (index < 0 || index >= nn->num_layers) return;
+    if (activation == ACTIVATION_SOFTMAX && index != nn->num_layers - 1) {
+        fprintf(stderr, "Error: Softmax is only supported on the output layer\n");
+        return;
+    }
+    Layer* layer = conv1d_layer_alloc(channels, length, kernel_size, filters, pool_size, pooling, activation);
+    if (layer == NULL) return;
+
+    plan_free(nn->plan);
+    nn->plan = NULL;
+    nn->layers[index] = layer;
+    layer_init_weights(layer, nn->seed, index);
+}
+
+void nn_set_seed(NeuralNetwork* nn, uint64_t seed) {
+    nn->seed = seed;
+    for (int i = 0; i < nn->num_layers; i++) {
+        if (nn->layers[i]) layer_init_weights(nn->layers[i], seed, i);
+    }
+}
+
+// Approximate FLOP counts for instrumentation (multiply-add = 2 FLOPs)
+static double forward_flops(Layer* layer, int batch) {
+    if (layer->type == LAYER_EMBEDDING) {
+        // One add per gathered element, padding slots included
+        return (double)layer->input->rows * layer->output_size * batch;
+    }
+    if (layer->type == LAYER_CONV1D) {
+        // Convolution, then one operation per pooled element and per output
+        return conv1d_flops(&layer->conv, batch) +
+               ((double)layer->conv.filters * layer->conv.conv_length + 2.0 * layer->output_size) * batch;
+    }
+    return (2.0 * layer->input_size + 2.0) * layer->output_size * batch;
+}
+
+static double backward_flops(Layer* layer, int batch, int propagate) {
+    if (layer->type == LAYER_EMBEDDING) return 0.0;  // Gradient applied in the update
+    if (layer->type == LAYER_CONV1D) {
+        return conv1d_flops(&layer->conv, batch) * (propagate ? 2.0 : 1.0);
+    }
+    double flops = (2.0 * layer->input_size + 1.0) * layer->output_size * batch;
+    if (propagate) flops += (2.0 * layer->output_size + 2.0) * layer->input_size * batch;
+    return flops;
+}
+
+static double update_flops(Layer* layer) {
+    if (layer->type == LAYER_EMBEDDING) {
+        return 2.0 * layer->input->rows * layer->input->cols * layer->output_size;
+    }
+    return 2.0 * (layer->weights->cols + 1.0) * layer->weights->rows;
+}
+
+static size_t matrix_bytes(const Matrix* m) {
+    return m ? (size_t)m->rows * m->cols * sizeof(double) : 0;
+}
+
+size_t nn_activation_bytes(const NeuralNetwork* nn) {
+    size_t bytes = 0;
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        bytes += matrix_bytes(layer->input) + matrix_bytes(layer->z) + matrix_bytes(layer->a) +
+                 matrix_bytes(layer->delta) + matrix_bytes(layer->columns) + matrix_bytes(layer->conv_out);
+    }
+    return bytes;
+}
+
+static void track_activation_bytes(NeuralNetwork* nn) {
+    size_t bytes = nn_activation_bytes(nn);
+    if (bytes > nn->activation_stats.peak_activation_bytes) {
+        nn->activation_stats.peak_activation_bytes = bytes;
+    }
+}
+
+static int recomputing(const NeuralNetwork* nn) {
+    return nn->recompute_interval >= 2;
+}
+
+// Layers whose input is kept under gradient checkpointing; the output
+// layer keeps everything for the loss
+static int keeps_input(const NeuralNetwork* nn, int i) {
+    return i % nn->recompute_interval == 0 || i == nn->num_layers - 1;
+}
+
+// Free what backpropagation can recompute. `a` is never needed below the
+// output layer: the next layer holds a copy as its input.
+static void discard_activations(Layer* layer, int keep_input) {
+    if (!keep_input) {
+        matrix_free(layer->input);
+        layer->input = NULL;
     }
+    matrix_free(layer->z);
+    matrix_free(layer->a);
+    matrix_free(layer->columns);
+    matrix_free(layer->conv_out);
+    layer->z = NULL;
+    layer->a = NULL;
+    layer->columns = NULL;
+    layer->conv_out = NULL;
 }
 
 Matrix* nn_forward(NeuralNetwork* nn, Matrix* input) {
     Matrix* current = input;
 
     for (int i = 0; i < nn->num_layers; i++) {
+        double start = nn->profiler ? profiler_now() : 0.0;
         current = layer_forward(nn->layers[i], current);
+        if (nn->profiler) {
+            profiler_record(nn->profiler, i, PROFILE_FORWARD, profiler_now() - start,
+                            forward_flops(nn->layers[i], current->cols));
+        }
+        nn->activation_stats.forward_layers++;
+        track_activation_bytes(nn);
+
+        // The previous layer's output now lives on as this layer's input
+        if (recomputing(nn) && i > 0) {
+            discard_activations(nn->layers[i - 1], keeps_input(nn, i - 1));
+        }
     }
 
     return current;
 }
 
-void nn_backward(NeuralNetwork* nn, Matrix* input, Matrix* target) {
-    // Compute output error
-    Layer* output_layer = nn->layers[nn->num_layers - 1];
-    Matrix* output_error = matrix_subtract(output_layer->a, target);
+// Rerun the forward pass of the segment holding layer `end`, from the
+// input kept at its first layer, so that layers up to `end` have their
+// caches back
+static void recompute_segment(NeuralNetwork* nn, int end) {
+    double segment_start = profiler_now();
+    int first = end - end % nn->recompute_interval;
+
+    for (int j = first; j <= end; j++) {
+        Layer* layer = nn->layers[j];
+        double start = nn->profiler ? profiler_now() : 0.0;
+        if (j > first) {
+            Layer* prev_layer = nn->layers[j - 1];
+            matrix_free(layer->input);
+            layer->input = prev_layer->a;
+            prev_layer->a = NULL;
+        }
+        layer_compute(layer);
+        if (nn->profiler) {
+            profiler_record(nn->profiler, j, PROFILE_RECOMPUTE, profiler_now() - start,
+                            forward_flops(layer, layer->input->cols));
+        }
+    }
+    // Only z and the inputs are needed from here on
+    matrix_free(nn->layers[end]->a);
+    nn->layers[end]->a = NULL;
+
+    nn->activation_stats.recomputed_layers += end - first + 1;
+    nn->activation_stats.recompute_seconds += profiler_now() - segment_start;
+}
 
-    // Compute output layer delta
-    Matrix* output_derivative = matrix_copy(output_layer->z);
-    apply_activation_derivative(output_derivative, output_layer->activation);
+void output_delta_mse(Matrix* delta, Matrix* a, Matrix* z, Matrix* target, ActivationType type) {
+    MatrixExpr e = matrix_expr(a);
+    expr_sub(&e, target);
+    ScalarFunction derivative = activation_derivative_function(type);
+    if (derivative) expr_mul_mapped(&e, z, derivative);
+    matrix_eval(delta, &e);
+}
 
+// Set the output layer's delta and return the loss of its prediction
+static double output_layer_delta(Layer* output_layer, Matrix* target) {
     if (output_layer->delta) matrix_free(output_layer->delta);
-    output_layer->delta = matrix_hadamard(output_error, output_derivative);
-    matrix_free(output_error);
-    matrix_free(output_derivative);
+
+    if (output_layer->activation == ACTIVATION_SOFTMAX) {
+        // The cross-entropy gradient w.r.t. the logits is probs - target,
+        // so the softmax Jacobian is never formed
+        output_layer->delta = matrix_create(target->rows, target->cols);
+        return softmax_cross_entropy(output_layer->z, target, output_layer->a, output_layer->delta);
+    }
+
+    double loss = mse_loss(output_layer->a, target);
+
+    // delta = (a - target) .* f'(z)
+    output_layer->delta = matrix_create(target->rows, target->cols);
+    output_delta_mse(output_layer->delta, output_layer->a, output_layer->z, target,
+                     output_layer->activation);
+
+    return loss;
+}
+
+// Backpropagation after nn_forward(); returns the loss
+static double backward(NeuralNetwork* nn, Matrix* target) {
+    double start = nn->profiler ? profiler_now() : 0.0;
+    double loss = output_layer_delta(nn->layers[nn->num_layers - 1], target);
+
+    // Gradients are averaged over the columns of a batch
+    double batch_scale = 1.0 / target->cols;
 
     // Backpropagate through hidden layers
     for (int i = nn->num_layers - 1; i >= 0; i--) {
         Layer* layer = nn->layers[i];
 
-        // Compute gradients
-        Matrix* input_T = matrix_transpose(layer->input);
-        Matrix* delta_T = matrix_transpose(layer->delta);
+        // Compute gradients; an embedding layer's gradient is applied
+        // straight from its delta in nn_update_weights()
+        if (layer->type == LAYER_DENSE) {
+            if (layer->dW) matrix_free(layer->dW);
+            layer->dW = matrix_create(layer->output_size, layer->input_size);
+            matrix_gemm(layer->dW, layer->delta, 0, layer->input, 1, batch_scale, 0.0);
+
+            if (layer->db) matrix_free(layer->db);
+            layer->db = matrix_sum_columns(layer->delta);
+            if (batch_scale != 1.0) {
+                MatrixExpr scale = matrix_expr(layer->db);
+                matrix_eval(layer->db, expr_scale(&scale, batch_scale));
+            }
+        }
 
-        if (layer->dW) matrix_free(layer->dW);
-        layer->dW = matrix_multiply(layer->delta, input_T);
+        // Propagate error to previous layer
+        Matrix* prev_delta = NULL;
+        if (i > 0) {
+            Layer* prev_layer = nn->layers[i - 1];
+            if (prev_layer->delta) matrix_free(prev_layer->delta);
+            prev_layer->delta = matrix_create(layer->input_size, layer->delta->cols);
+            prev_delta = prev_layer->delta;
+        }
 
-        if (layer->db) matrix_free(layer->db);
-        layer->db = matrix_copy(layer->delta);
+        if (layer->type == LAYER_CONV1D) {
+            // Gradients and the input gradient through pooling and im2col
+            conv1d_backward(layer, batch_scale, prev_delta);
+        } else if (prev_delta) {
+            // prev_delta = W^T * delta
+            matrix_gemm(prev_delta, layer->weights, 1, layer->delta, 0, 1.0, 0.0);
+        }
 
-        matrix_free(input_T);
-        matrix_free(delta_T);
+        // Under gradient checkpointing this layer's caches and delta are
+        // done with (an embedding layer's delta is applied in the update),
+        // and the previous layer's segment is recomputed if it was freed
+        if (recomputing(nn) && i < nn->num_layers - 1) {
+            discard_activations(layer, keeps_input(nn, i));
+            if (layer->type != LAYER_EMBEDDING) {
+                matrix_free(layer->delta);
+                layer->delta = NULL;
+            }
+        }
+        if (prev_delta && recomputing(nn) && nn->layers[i - 1]->z == NULL) {
+            double now = profiler_now();
+            if (nn->profiler) profiler_record(nn->profiler, i, PROFILE_BACKWARD, now - start, 0.0);
+            recompute_segment(nn, i - 1);
+            start = profiler_now();
+        }
 
-        // Propagate error to previous layer
-        if (i > 0) {
+        // prev_delta .*= f'(z_prev)
+        if (prev_delta) {
             Layer* prev_layer = nn->layers[i - 1];
-            Matrix* weights_T = matrix_transpose(layer->weights);
-            Matrix* prev_error = matrix_multiply(weights_T, layer->delta);
+            multiply_activation_derivative(prev_delta, prev_layer->z, prev_layer->activation);
+        }
+        track_activation_bytes(nn);
 
-            Matrix* prev_derivative = matrix_copy(prev_layer->z);
-            apply_activation_derivative(prev_derivative, prev_layer->activation);
+        if (nn->profiler) {
+            double now = profiler_now();
+            profiler_record(nn->profiler, i, PROFILE_BACKWARD, now - start,
+                            backward_flops(layer, target->cols, i > 0));
+            start = now;
+        }
+    }
 
-            if (prev_layer->delta) matrix_free(prev_layer->delta);
-            prev_layer->delta = matrix_hadamard(prev_error, prev_derivative);
+    return loss;
+}
+
+void nn_backward(NeuralNetwork* nn, Matrix* input, Matrix* target) {
+    (void)input;  // Layer inputs are cached by nn_forward
+    backward(nn, target);
+}
 
-            matrix_free(weights_T);
-            matrix_free(prev_error);
-            matrix_free(prev_derivative);
+// SGD step for an embedding layer: only the rows of tokens present in
+// the batch are touched
+static void embedding_update(Layer* layer, double learning_rate) {
+    Matrix* ids = layer->input;
+    Matrix* delta = layer->delta;
+    double step = learning_rate / delta->cols;
+
+    for (int j = 0; j < ids->cols; j++) {
+        double scale = step;
+        if (layer->pooling == POOLING_MEAN) {
+            int count = token_count(layer, ids, j);
+            if (count > 1) scale /= count;
+        }
+
+        for (int t = 0; t < ids->rows; t++) {
+            int id = (int)MATRIX_AT(ids, t, j);
+            if (id < 0 || id >= layer->input_size) continue;
+
+            double* row = matrix_row(layer->weights, id);
+            for (int d = 0; d < layer->output_size; d++) {
+                row[d] -= scale * MATRIX_AT(delta, d, j);
+            }
         }
     }
 }
@@ -220,20 +729,31 @@ void nn_backward(NeuralNetwork* nn, Matrix* input, Matrix* target) {
 void nn_update_weights(NeuralNetwork* nn) {
     for (int i = 0; i < nn->num_layers; i++) {
         Layer* layer = nn->layers[i];
+        double start = nn->profiler ? profiler_now() : 0.0;
+
+        if (layer->type == LAYER_EMBEDDING) {
+            embedding_update(layer, nn->learning_rate);
+            if (nn->profiler) {
+                profiler_record(nn->profiler, i, PROFILE_UPDATE, profiler_now() - start,
+                                update_flops(layer));
+            }
+            continue;
+        }
+
+        // W -= learning_rate * dW and b -= learning_rate * db, in place and
+        // in one pass each; a pruning mask is applied in the same pass
+        MatrixExpr weights = matrix_expr(layer->weights);
+        expr_add_scaled(&weights, layer->dW, -nn->learning_rate);
+        if (layer->mask) expr_mul(&weights, layer->mask);
+        matrix_eval(layer->weights, &weights);
 
-        // Update weights: W = W - learning_rate * dW
-        Matrix* weight_update = matrix_multiply_scalar(layer->dW, nn->learning_rate);
-        Matrix* new_weights = matrix_subtract(layer->weights, weight_update);
-        matrix_free(layer->weights);
-        layer->weights = new_weights;
-        matrix_free(weight_update);
+        MatrixExpr biases = matrix_expr(layer->biases);
+        matrix_eval(layer->biases, expr_add_scaled(&biases, layer->db, -nn->learning_rate));
 
-        // Update biases: b = b - learning_rate * db
-        Matrix* bias_update = matrix_multiply_scalar(layer->db, nn->learning_rate);
-        Matrix* new_biases = matrix_subtract(layer->biases, bias_update);
-        matrix_free(layer->biases);
-        layer->biases = new_biases;
-        matrix_free(bias_update);
+        if (nn->profiler) {
+            profiler_record(nn->profiler, i, PROFILE_UPDATE, profiler_now() - start,
+                            update_flops(layer));
+        }
     }
 }
 
@@ -242,7 +762,7 @@ double mse_loss(Matrix* predicted, Matrix* target) {
     double sum = 0.0;
     for (int i = 0; i < predicted->rows; i++) {
         for (int j = 0; j < predicted->cols; j++) {
-            double diff = predicted->data[i][j] - target->data[i][j];
+            double diff = MATRIX_AT(predicted, i, j) - MATRIX_AT(target, i, j);
             sum += diff * diff;
         }
     }
@@ -253,28 +773,120 @@ Matrix* mse_loss_derivative(Matrix* predicted, Matrix* target) {
     return matrix_subtract(predicted, target);
 }
 
-// Training
-void nn_train(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples, int epochs) {
-    for (int epoch = 0; epoch < epochs; epoch++) {
-        double total_loss = 0.0;
+double cross_entropy_loss(Matrix* predicted, Matrix* target) {
+    double sum = 0.0;
+    for (int i = 0; i < predicted->rows; i++) {
+        for (int j = 0; j < predicted->cols; j++) {
+            if (MATRIX_AT(target, i, j) != 0.0) {
+                double p = MATRIX_AT(predicted, i, j) > 1e-300 ? MATRIX_AT(predicted, i, j) : 1e-300;
+                sum -= MATRIX_AT(target, i, j) * log(p);
+            }
+        }
+    }
+    return sum / predicted->cols;
+}
 
-        for (int i = 0; i < num_samples; i++) {
-            // Forward pass
-            Matrix* output = nn_forward(nn, inputs[i]);
+double softmax_cross_entropy(Matrix* logits, Matrix* target, Matrix* probs, Matrix* delta) {
+    int rows = logits->rows;
+    int cols = logits->cols;
+    double* col_max = (double*)malloc(cols * sizeof(double));
+    double* col_sum = (double*)calloc(cols, sizeof(double));
+
+    for (int j = 0; j < cols; j++) col_max[j] = MATRIX_AT(logits, 0, j);
+    for (int i = 1; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            double z = MATRIX_AT(logits, i, j);
+            col_max[j] = z > col_max[j] ? z : col_max[j];
+        }
+    }
 
-            // Compute loss
-            double loss = mse_loss(output, targets[i]);
-            total_loss += loss;
+    // Unnormalized probabilities; also accumulates sum(t * (z - max))
+    double loss = 0.0;
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            double shifted = MATRIX_AT(logits, i, j) - col_max[j];
+            MATRIX_AT(probs, i, j) = exp(shifted);
+            col_sum[j] += MATRIX_AT(probs, i, j);
+            loss -= MATRIX_AT(target, i, j) * shifted;
+        }
+    }
 
-            // Backward pass
-            nn_backward(nn, inputs[i], targets[i]);
+    // -log p = -(z - max) + log(sum), weighted by each column's target mass;
+    // the log is taken of the sum rather than of p, so it never underflows
+    for (int j = 0; j < cols; j++) {
+        double mass = 0.0;
+        for (int i = 0; i < rows; i++) mass += MATRIX_AT(target, i, j);
+        loss += mass * log(col_sum[j]);
+        col_sum[j] = 1.0 / col_sum[j];
+    }
 
-            // Update weights
-            nn_update_weights(nn);
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            MATRIX_AT(probs, i, j) *= col_sum[j];
+            MATRIX_AT(delta, i, j) = MATRIX_AT(probs, i, j) - MATRIX_AT(target, i, j);
         }
+    }
+
+    free(col_max);
+    free(col_sum);
+    return loss / cols;
+}
+
+// Training
+// Also accepts a mini-batch: input and target hold one example per column
+double nn_compute_gradients(NeuralNetwork* nn, Matrix* input, Matrix* target) {
+    // Forward pass
+    nn_forward(nn, input);
 
-        if ((epoch + 1) % 100 == 0 || epoch == 0) {
-            printf("Epoch %d/%d - Loss: %.6f\n", epoch + 1, epochs, total_loss / num_samples);
+    // Backward pass; the loss comes out of the output-layer gradient pass
+    return backward(nn, target);
+}
+
+double nn_train_sample(NeuralNetwork* nn, Matrix* input, Matrix* target) {
+    // The plan binds the caller's data without checks; anything it was not
+    // compiled for takes the regular path, which reports shape errors
+    if (nn->plan && input->cols == nn->plan->batch_size && target->cols == input->cols &&
+        input->rows == nn->layers[0]->input_size &&
+        target->rows == nn->layers[nn->num_layers - 1]->output_size) {
+        return plan_train_step(nn->plan, input, target);
+    }
+
+    double loss = nn_compute_gradients(nn, input, target);
+
+    // Update weights
+    nn_update_weights(nn);
+
+    return loss;
+}
+
+void nn_report_epoch(int epoch, int epochs, double average_loss) {
+    if ((epoch + 1) % 100 == 0 || epoch == 0) {
+        printf("Epoch %d/%d - Loss: %.6f\n", epoch + 1, epochs, average_loss);
+    }
+}
+
+int nn_end_epoch(NeuralNetwork* nn, int epoch, int epochs, long samples, double average_loss) {
+    if (nn->profiler) profiler_end_epoch(nn->profiler, epoch, samples, average_loss);
+    nn_report_epoch(epoch, epochs, average_loss);
+
+    int stop = nn->early_stopping && early_stopping_end_epoch(nn->early_stopping, nn, epoch, epochs);
+    if (nn->checkpointer) {
+        if (stop) checkpointer_snapshot(nn->checkpointer, nn, epoch);
+        else checkpointer_end_epoch(nn->checkpointer, nn, epoch, epochs);
+    }
+    return stop;
+}
+
+void nn_train(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples, int epochs) {
+    int first_epoch = nn->checkpointer ? checkpointer_start_epoch(nn->checkpointer) : 0;
+    for (int epoch = first_epoch; epoch < epochs; epoch++) {
+        double total_loss = 0.0;
+        if (nn->profiler) profiler_begin_epoch(nn->profiler);
+
+        for (int i = 0; i < num_samples; i++) {
+            total_loss += nn_train_sample(nn, inputs[i], targets[i]);
         }
+
+        if (nn_end_epoch(nn, epoch, epochs, num_samples, total_loss / num_samples)) break;
     }
 }
@@ -2,21 +2,57 @@
 #define NEURAL_NETWORK_H
 
 #include "matrix.h"
+#include "profiler.h"
 
 // Activation function types
 typedef enum {
     ACTIVATION_SIGMOID,
     ACTIVATION_TANH,
     ACTIVATION_RELU,
-    ACTIVATION_LINEAR
+    ACTIVATION_LINEAR,
+    ACTIVATION_SOFTMAX  // Output layer only; trained with cross-entropy loss
 } ActivationType;
 
+typedef enum {
+    LAYER_DENSE,
+    LAYER_EMBEDDING,  // Token ids in, pooled embedding rows out; first layer only
+    LAYER_CONV1D      // Convolution over sequences, then pooling; see conv1d.h
+} LayerType;
+
+// How an embedding layer combines the rows of a document's tokens, or a
+// convolution layer the positions of each pooling window
+typedef enum {
+    POOLING_SUM,   // Embedding layers only
+    POOLING_MEAN,
+    POOLING_MAX    // Convolution layers only
+} PoolingType;
+
+// Geometry of a 1D convolution layer. Its input holds `channels` sequences
+// of `length` positions per column, channel-major (row c * length + t).
+// Filters are applied at every position where they fit (stride 1, no
+// padding) and the conv_length results are pooled in windows of
+// pool_size, giving filters * pooled_length outputs in the same layout.
+typedef struct {
+    int channels;
+    int length;
+    int kernel_size;
+    int filters;
+    int conv_length;    // length - kernel_size + 1
+    int pool_size;
+    int pooled_length;  // conv_length / pool_size; a partial last window is dropped
+} Conv1DShape;
+
 // Layer structure
 typedef struct {
-    int input_size;
+    LayerType type;
+    PoolingType pooling;  // Embedding and convolution layers
+    Conv1DShape conv;     // Convolution layers only
+    int input_size;       // Vocabulary size for embedding layers
     int output_size;
-    Matrix* weights;
-    Matrix* biases;
+    Matrix* weights;  // (output x input); embedding table is (vocab x dim), one row per token;
+                      // convolution filters are (filters x channels * kernel_size)
+    Matrix* biases;   // NULL for embedding layers
+    Matrix* mask;     // Set by nn_prune(): 0 for pruned weights, kept at zero by updates
     ActivationType activation;
 
     // Cache for backpropagation
@@ -26,13 +62,42 @@ typedef struct {
     Matrix* dW; // Weight gradients
     Matrix* db; // Bias gradients
     Matrix* delta; // Error term
+    Matrix* columns;   // Convolution layers: im2col lowering of the input, NULL when direct
+    Matrix* conv_out;  // Convolution layers: pre-activation before pooling
 } Layer;
 
+// Compiled buffer schedule for fixed-size batches, see plan.h
+typedef struct ExecutionPlan ExecutionPlan;
+// Background checkpoint writer, see checkpoint.h
+typedef struct Checkpointer Checkpointer;
+// Validation-based stopping, see evaluate.h
+typedef struct EarlyStopping EarlyStopping;
+
+// Activation memory and recomputation counters, kept by the regular
+// (uncompiled) training path; zero them to start a new measurement
+typedef struct {
+    size_t peak_activation_bytes;          // Most bytes held by layer caches (input, z, a, delta, ...)
+    unsigned long long forward_layers;     // Layer forwards run by nn_forward()
+    unsigned long long recomputed_layers;  // Layer forwards rerun during backpropagation
+    double recompute_seconds;
+} ActivationStats;
+
 // Neural Network structure
 typedef struct {
     int num_layers;
     Layer** layers;
     double learning_rate;
+    uint64_t seed;  // Weight initialization; layer i draws from Philox stream i
+    TrainingProfiler* profiler;  // Optional instrumentation, NULL by default (not owned)
+    ExecutionPlan* plan;         // Set by nn_compile(), owned
+    Checkpointer* checkpointer;  // Optional periodic checkpoints, NULL by default (not owned)
+    EarlyStopping* early_stopping;  // Optional held-out evaluation, NULL by default (not owned)
+    // Gradient checkpointing: with k >= 2, nn_forward() keeps the input of
+    // every k-th layer (and the output layer's state) and frees the rest as
+    // it goes; backpropagation recomputes each k-layer segment from its
+    // kept input when it reaches it. 0 (default) keeps every layer's cache.
+    int recompute_interval;
+    ActivationStats activation_stats;
 } NeuralNetwork;
 
 // Activation functions and their derivatives
@@ -45,28 +110,82 @@ double relu_derivative(double x);
 double linear(double x);
 double linear_derivative(double x);
 
+// Scalar activation and derivative for use in matrix expressions; NULL for
+// linear (identity) and softmax (not element-wise)
+typedef double (*ScalarFunction)(double);
+ScalarFunction activation_function(ActivationType type);
+ScalarFunction activation_derivative_function(ActivationType type);
+
+// Numerically stable softmax over each column (subtracts the column max)
+void softmax_columns(Matrix* m);
+
 // Apply activation functions to matrices
 void apply_activation(Matrix* m, ActivationType type);
 void apply_activation_derivative(Matrix* m, ActivationType type);
+// Fused single-pass forms: a = f(z); delta .*= f'(z);
+// delta = (a - target) .* f'(z) for the MSE output layer
+void activation_forward(Matrix* a, Matrix* z, ActivationType type);
+void multiply_activation_derivative(Matrix* delta, Matrix* z, ActivationType type);
+void output_delta_mse(Matrix* delta, Matrix* a, Matrix* z, Matrix* target, ActivationType type);
 
 // Layer operations
 Layer* layer_create(int input_size, int output_size, ActivationType activation);
 void layer_free(Layer* layer);
 Matrix* layer_forward(Layer* layer, Matrix* input);
+// Inference only: output (output_size x batch) = activation(W * input + b),
+// or the pooled embedding. Touches no layer state, so threads may share it.
+void layer_infer(const Layer* layer, const Matrix* input, Matrix* output);
+// Embedding layer: input is (max_tokens x batch) token ids, padded with -1;
+// output is the (dim x batch) sum or mean of each column's embedding rows
+Layer* embedding_layer_create(int vocab_size, int embedding_dim, PoolingType pooling);
+// Convolution layer: z = pool(W * x + b), a = f(z); see Conv1DShape. For
+// POOLING_MAX and the monotonic activations this equals pooling after the
+// activation.
+Layer* conv1d_layer_create(int channels, int length, int kernel_size, int filters,
+                           int pool_size, PoolingType pooling, ActivationType activation);
 
 // Neural Network operations
 NeuralNetwork* nn_create(int num_layers);
 void nn_free(NeuralNetwork* nn);
+// ACTIVATION_SOFTMAX is rejected (the layer is not added) except on the last layer
 void nn_add_layer(NeuralNetwork* nn, int index, int input_size, int output_size, ActivationType activation);
+void nn_add_embedding_layer(NeuralNetwork* nn, int index, int vocab_size, int embedding_dim, PoolingType pooling);
+// pool_size = length - kernel_size + 1 pools each filter over the whole sequence
+void nn_add_conv1d_layer(NeuralNetwork* nn, int index, int channels, int length, int kernel_size,
+                         int filters, int pool_size, PoolingType pooling, ActivationType activation);
+// Re-initialize every layer from `seed`; layers added later also use it.
+// The same seed gives the same weights on any machine and thread count.
+void nn_set_seed(NeuralNetwork* nn, uint64_t seed);
+// Fix the shapes of every intermediate for batches of `batch_size` columns
+// and lay them out in one arena. nn_train_sample() then runs batches of
+// that size through the plan without allocating; other sizes take the
+// regular path. Dense layers only; returns 1 if the network cannot be compiled.
+int nn_compile(NeuralNetwork* nn, int batch_size);
 Matrix* nn_forward(NeuralNetwork* nn, Matrix* input);
+// Bytes currently held by the layers' activation and delta caches
+size_t nn_activation_bytes(const NeuralNetwork* nn);
 void nn_backward(NeuralNetwork* nn, Matrix* input, Matrix* target);
 void nn_update_weights(NeuralNetwork* nn);
 
 // Loss functions
 double mse_loss(Matrix* predicted, Matrix* target);
 Matrix* mse_loss_derivative(Matrix* predicted, Matrix* target);
+double cross_entropy_loss(Matrix* predicted, Matrix* target);
+// Fused softmax + cross-entropy: from the logits computes the probabilities,
+// the gradient w.r.t. the logits (probs - target) and the mean loss per
+// column in one pass. probs and delta must match the shape of logits.
+double softmax_cross_entropy(Matrix* logits, Matrix* target, Matrix* probs, Matrix* delta);
 
 // Training
+// Forward and backward pass without the update: fills every layer's dW
+// and db and returns the loss (always the regular, uncompiled path)
+double nn_compute_gradients(NeuralNetwork* nn, Matrix* input, Matrix* target);
+double nn_train_sample(NeuralNetwork* nn, Matrix* input, Matrix* target); // One SGD step on a sample or batch, returns loss
+void nn_report_epoch(int epoch, int epochs, double average_loss);
+// Shared end of an epoch for the training loops: profiler, progress line,
+// early stopping, then the checkpoint. Early stopping runs first so that
+// a run it ends snapshots the restored best weights. Returns 1 to stop.
+int nn_end_epoch(NeuralNetwork* nn, int epoch, int epochs, long samples, double average_loss);
 void nn_train(NeuralNetwork* nn, Matrix** inputs, Matrix** targets, int num_samples, int epochs);
 
 #endif
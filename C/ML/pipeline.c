@@ -0,0 +1,245 @@
+#include "pipeline.h"
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// SplitMix64 step, used for the per-epoch shuffle
+static uint64_t next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void shuffle_range(int* values, int count, uint64_t* state) {
+    for (int i = count - 1; i > 0; i--) {
+        int j = (int)(next_random(state) % (uint64_t)(i + 1));
+        int tmp = values[i];
+        values[i] = values[j];
+        values[j] = tmp;
+    }
+}
+
+// Build the example order for one epoch: windows of consecutive examples
+// are visited in random order and shuffled internally, so reads stay
+// local to one window of the source at a time
+static void build_epoch_order(InputPipeline* p, long epoch, int* order) {
+    int n = p->num_examples;
+    int window = p->shuffle_window;
+
+    if (window <= 1) {
+        for (int i = 0; i < n; i++) order[i] = i;
+        return;
+    }
+    if (window > n) window = n;
+
+    uint64_t state = p->seed + (uint64_t)epoch * 0x9E3779B97F4A7C15ULL;
+    int num_windows = (n + window - 1) / window;
+    int* window_order = (int*)malloc(num_windows * sizeof(int));
+    for (int w = 0; w < num_windows; w++) window_order[w] = w;
+    shuffle_range(window_order, num_windows, &state);
+
+    int pos = 0;
+    for (int w = 0; w < num_windows; w++) {
+        int start = window_order[w] * window;
+        int len = (start + window <= n) ? window : n - start;
+        for (int k = 0; k < len; k++) order[pos + k] = start + k;
+        shuffle_range(order + pos, len, &state);
+        pos += len;
+    }
+
+    free(window_order);
+}
+
+// A worker may build batch `sequence` once its ring slot has been released
+// and it is at most one epoch ahead of the consumer
+static int can_claim(InputPipeline* p) {
+    long seq = p->next_claim;
+    return seq < p->consumed + p->capacity &&
+           seq / p->batches_per_epoch <= p->consumed / p->batches_per_epoch + 1;
+}
+
+static void* pipeline_worker(void* arg) {
+    InputPipeline* p = (InputPipeline*)arg;
+    double* input = (double*)malloc(p->input_size * sizeof(double));
+    double* target = (double*)malloc(p->target_size * sizeof(double));
+
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        while (!p->shutdown && !can_claim(p)) {
+            pthread_cond_wait(&p->slot_free, &p->lock);
+        }
+        if (p->shutdown) {
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+
+        long seq = p->next_claim++;
+        long epoch = seq / p->batches_per_epoch;
+        long batch_index = seq % p->batches_per_epoch;
+        int* order = p->order[epoch % 2];
+        if (batch_index == 0) {
+            build_epoch_order(p, epoch, order);
+        }
+        pthread_mutex_unlock(&p->lock);
+
+        PipelineBatch* batch = &p->slots[seq % p->capacity];
+        int first = (int)(batch_index * p->batch_size);
+        int size = p->num_examples - first < p->batch_size ? p->num_examples - first : p->batch_size;
+
+        // Buffers hold a full batch; a short final batch is packed at the
+        // narrower width
+        batch->inputs->cols = size;
+        batch->targets->cols = size;
+        for (int j = 0; j < size; j++) {
+            p->fetch(p->source, order[first + j], input, target);
+            for (int f = 0; f < p->input_size; f++) MATRIX_AT(batch->inputs, f, j) = input[f];
+            for (int f = 0; f < p->target_size; f++) MATRIX_AT(batch->targets, f, j) = target[f];
+        }
+
+        pthread_mutex_lock(&p->lock);
+        batch->size = size;
+        batch->sequence = seq;
+        batch->ready = 1;
+        pthread_cond_broadcast(&p->batch_ready);
+        pthread_mutex_unlock(&p->lock);
+    }
+
+    free(input);
+    free(target);
+    return NULL;
+}
+
+InputPipeline* pipeline_create(PipelineFetchFn fetch, void* source, int num_examples,
+                               int input_size, int target_size, int batch_size,
+                               int shuffle_window, int capacity, int num_workers,
+                               uint64_t seed) {
+    if (num_examples <= 0 || batch_size <= 0) {
+        fprintf(stderr, "Pipeline needs at least one example and a positive batch size\n");
+        return NULL;
+    }
+
+    InputPipeline* p = (InputPipeline*)malloc(sizeof(InputPipeline));
+    p->fetch = fetch;
+    p->source = source;
+    p->num_examples = num_examples;
+    p->input_size = input_size;
+    p->target_size = target_size;
+    p->batch_size = batch_size;
+    p->shuffle_window = shuffle_window;
+    p->capacity = capacity < 2 ? 2 : capacity;
+    p->num_workers = num_workers < 1 ? 1 : num_workers;
+    p->seed = seed;
+
+    p->batches_per_epoch = (num_examples + batch_size - 1) / batch_size;
+    p->order[0] = (int*)malloc(num_examples * sizeof(int));
+    p->order[1] = (int*)malloc(num_examples * sizeof(int));
+    p->next_claim = 0;
+    p->consumed = 0;
+    p->delivered = 0;
+    p->epoch_boundary = 0;
+    p->shutdown = 0;
+    p->epoch_stall_seconds = 0.0;
+    p->total_stall_seconds = 0.0;
+
+    p->slots = (PipelineBatch*)malloc(p->capacity * sizeof(PipelineBatch));
+    for (int i = 0; i < p->capacity; i++) {
+        p->slots[i].inputs = matrix_create(input_size, batch_size);
+        p->slots[i].targets = matrix_create(target_size, batch_size);
+        p->slots[i].size = 0;
+        p->slots[i].sequence = -1;
+        p->slots[i].ready = 0;
+    }
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->slot_free, NULL);
+    pthread_cond_init(&p->batch_ready, NULL);
+
+    p->workers = (pthread_t*)malloc(p->num_workers * sizeof(pthread_t));
+    for (int i = 0; i < p->num_workers; i++) {
+        pthread_create(&p->workers[i], NULL, pipeline_worker, p);
+    }
+
+    return p;
+}
+
+void pipeline_free(InputPipeline* p) {
+    if (p == NULL) return;
+
+    pthread_mutex_lock(&p->lock);
+    p->shutdown = 1;
+    pthread_cond_broadcast(&p->slot_free);
+    pthread_mutex_unlock(&p->lock);
+
+    for (int i = 0; i < p->num_workers; i++) {
+        pthread_join(p->workers[i], NULL);
+    }
+
+    for (int i = 0; i < p->capacity; i++) {
+        matrix_free(p->slots[i].inputs);
+        matrix_free(p->slots[i].targets);
+    }
+
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->slot_free);
+    pthread_cond_destroy(&p->batch_ready);
+    free(p->slots);
+    free(p->workers);
+    free(p->order[0]);
+    free(p->order[1]);
+    free(p);
+}
+
+PipelineBatch* pipeline_next_batch(InputPipeline* p) {
+    pthread_mutex_lock(&p->lock);
+
+    // Release the batch handed out by the previous call
+    if (p->delivered > p->consumed) {
+        p->slots[p->consumed % p->capacity].ready = 0;
+        p->consumed++;
+        pthread_cond_broadcast(&p->slot_free);
+    }
+
+    if (p->delivered > 0 && p->delivered % p->batches_per_epoch == 0 && !p->epoch_boundary) {
+        p->epoch_boundary = 1;
+        pthread_mutex_unlock(&p->lock);
+        return NULL;
+    }
+    if (p->epoch_boundary) {
+        p->epoch_boundary = 0;
+        p->epoch_stall_seconds = 0.0;
+    }
+
+    PipelineBatch* batch = &p->slots[p->delivered % p->capacity];
+    if (!(batch->ready && batch->sequence == p->delivered)) {
+        double start = profiler_now();
+        while (!(batch->ready && batch->sequence == p->delivered)) {
+            pthread_cond_wait(&p->batch_ready, &p->lock);
+        }
+        double stalled = profiler_now() - start;
+        p->epoch_stall_seconds += stalled;
+        p->total_stall_seconds += stalled;
+    }
+    p->delivered++;
+
+    pthread_mutex_unlock(&p->lock);
+    return batch;
+}
+
+void nn_train_pipeline(NeuralNetwork* nn, InputPipeline* pipeline, int epochs) {
+    int first_epoch = nn->checkpointer ? checkpointer_start_epoch(nn->checkpointer) : 0;
+    for (int epoch = first_epoch; epoch < epochs; epoch++) {
+        double total_loss = 0.0;
+        if (nn->profiler) profiler_begin_epoch(nn->profiler);
+
+        PipelineBatch* batch;
+        while ((batch = pipeline_next_batch(pipeline)) != NULL) {
+            total_loss += nn_train_sample(nn, batch->inputs, batch->targets) * batch->size;
+        }
+
+        // Reported through the profiler's input_stall_seconds column
+        if (nn->profiler) nn->profiler->input_stall_seconds = pipeline->epoch_stall_seconds;
+        if (nn_end_epoch(nn, epoch, epochs, pipeline->num_examples, total_loss / pipeline->num_examples)) break;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "neural_network.h"
+
+// Produces one example: writes input_size values to `input` and
+// target_size values to `target`. Called concurrently from worker threads,
+// so it must only read shared state. This is where loading and
+// featurization happen.
+typedef void (*PipelineFetchFn)(void* source, int index, double* input, double* target);
+
+// A mini-batch, one example per column
+typedef struct {
+    Matrix* inputs;   // input_size x size
+    Matrix* targets;  // target_size x size
+    int size;
+    long sequence;    // Global batch number, across epochs
+    int ready;
+} PipelineBatch;
+
+// Bounded producer/consumer pipeline. Worker threads shuffle example order
+// within a window, fetch examples and assemble batches into a ring of
+// `capacity` slots while the training thread consumes them in order.
+typedef struct {
+    PipelineFetchFn fetch;
+    void* source;
+    int num_examples;
+    int input_size;
+    int target_size;
+    int batch_size;
+    int shuffle_window;
+    int capacity;
+    int num_workers;
+    uint64_t seed;
+
+    long batches_per_epoch;
+    int* order[2];        // Example order for the two epochs that can be in flight
+    long next_claim;      // Next batch sequence a worker will build
+    long consumed;        // Batches released by the consumer
+    long delivered;       // Batches handed to the consumer
+    int epoch_boundary;   // Set once NULL has been returned for the current boundary
+    int shutdown;
+
+    PipelineBatch* slots;
+    pthread_t* workers;
+    pthread_mutex_t lock;
+    pthread_cond_t slot_free;
+    pthread_cond_t batch_ready;
+
+    double epoch_stall_seconds;  // Time the consumer waited during the last epoch
+    double total_stall_seconds;
+} InputPipeline;
+
+// Create and start a pipeline. shuffle_window <= 1 keeps file order;
+// shuffle_window >= num_examples shuffles the whole epoch. capacity is the
+// number of batches buffered ahead (at least 2, i.e. double buffering).
+InputPipeline* pipeline_create(PipelineFetchFn fetch, void* source, int num_examples,
+                               int input_size, int target_size, int batch_size,
+                               int shuffle_window, int capacity, int num_workers,
+                               uint64_t seed);
+void pipeline_free(InputPipeline* pipeline);
+
+// Next batch of the current epoch, or NULL once the epoch is exhausted (the
+// following call starts the next epoch). The returned batch stays valid
+// until the next call.
+PipelineBatch* pipeline_next_batch(InputPipeline* pipeline);
+
+// Train on batches from the pipeline; the input stall time of each epoch
+// goes to the attached profiler
+void nn_train_pipeline(NeuralNetwork* nn, InputPipeline* pipeline, int epochs);
+
+#endif
@@ -0,0 +1,307 @@
+#include "plan.h"
+#include "matrix_expr.h"
+#include <limits.h>
+
+#define ARENA_ALIGNMENT 64
+
+// Intermediates of each layer, in buffer index order
+enum {
+    BUFFER_Z,
+    BUFFER_A,
+    BUFFER_DELTA,
+    BUFFER_DW,
+    BUFFER_DB,
+    BUFFERS_PER_LAYER
+};
+
+// Operand ids for plan_add_step() that are not arena buffers
+#define OPERAND_NONE   -1
+#define OPERAND_INPUT  -2
+#define OPERAND_TARGET -3
+
+static int buffer_id(int layer, int kind) {
+    return layer * BUFFERS_PER_LAYER + kind;
+}
+
+static Matrix* operand(ExecutionPlan* plan, int id, int step) {
+    if (id == OPERAND_NONE) return NULL;
+    if (id == OPERAND_INPUT) return plan->input;
+    if (id == OPERAND_TARGET) return plan->target;
+
+    PlanBuffer* buffer = &plan->buffers[id];
+    if (step < buffer->first_step) buffer->first_step = step;
+    if (step > buffer->last_step) buffer->last_step = step;
+    return buffer->matrix;
+}
+
+static void plan_add_step(ExecutionPlan* plan, PlanOp op, int layer, ProfilePhase phase,
+                          double flops, int out, int in, int aux) {
+    int index = plan->num_steps++;
+    PlanStep* step = &plan->steps[index];
+    step->op = op;
+    step->layer = layer;
+    step->phase = phase;
+    step->flops = flops;
+    step->out = operand(plan, out, index);
+    step->in = operand(plan, in, index);
+    step->aux = operand(plan, aux, index);
+}
+
+static int lifetimes_overlap(const PlanBuffer* a, const PlanBuffer* b) {
+    return a->first_step <= b->last_step && b->first_step <= a->last_step;
+}
+
+static int compare_buffer_size(const void* a, const void* b) {
+    const PlanBuffer* x = *(const PlanBuffer* const*)a;
+    const PlanBuffer* y = *(const PlanBuffer* const*)b;
+    return (x->bytes < y->bytes) - (x->bytes > y->bytes);
+}
+
+// Greedy placement, largest buffers first: each buffer goes at the lowest
+// offset that does not collide with an already placed buffer that is
+// live at the same time
+static size_t assign_offsets(PlanBuffer* buffers, int count) {
+    PlanBuffer** order = (PlanBuffer**)malloc(count * sizeof(PlanBuffer*));
+    for (int i = 0; i < count; i++) order[i] = &buffers[i];
+    qsort(order, count, sizeof(PlanBuffer*), compare_buffer_size);
+
+    size_t arena_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        PlanBuffer* buffer = order[i];
+        size_t offset = 0;
+        int moved = 1;
+        while (moved) {
+            moved = 0;
+            for (int j = 0; j < i; j++) {
+                PlanBuffer* placed = order[j];
+                if (!lifetimes_overlap(buffer, placed)) continue;
+                if (offset < placed->offset + placed->bytes && placed->offset < offset + buffer->bytes) {
+                    offset = placed->offset + placed->bytes;
+                    moved = 1;
+                }
+            }
+        }
+        buffer->offset = offset;
+        if (offset + buffer->bytes > arena_bytes) arena_bytes = offset + buffer->bytes;
+    }
+
+    free(order);
+    return arena_bytes;
+}
+
+static int check_compilable(NeuralNetwork* nn, int batch_size) {
+    if (batch_size <= 0) {
+        fprintf(stderr, "Error: nn_compile needs a positive batch size\n");
+        return 1;
+    }
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        if (layer == NULL) {
+            fprintf(stderr, "Error: nn_compile: layer %d has not been added\n", i);
+            return 1;
+        }
+        if (layer->type != LAYER_DENSE) {
+            fprintf(stderr, "Error: nn_compile supports dense layers only (layer %d)\n", i);
+            return 1;
+        }
+        if (i > 0 && layer->input_size != nn->layers[i - 1]->output_size) {
+            fprintf(stderr, "Error: nn_compile: layer %d expects %d inputs but layer %d has %d outputs\n",
+                    i, layer->input_size, i - 1, nn->layers[i - 1]->output_size);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int nn_compile(NeuralNetwork* nn, int batch_size) {
+    if (check_compilable(nn, batch_size)) return 1;
+
+    plan_free(nn->plan);
+    nn->plan = NULL;
+
+    int num_layers = nn->num_layers;
+    int last = num_layers - 1;
+    ExecutionPlan* plan = (ExecutionPlan*)malloc(sizeof(ExecutionPlan));
+    plan->nn = nn;
+    plan->batch_size = batch_size;
+    plan->input = matrix_wrap(NULL, nn->layers[0]->input_size, batch_size);
+    plan->target = matrix_wrap(NULL, nn->layers[last]->output_size, batch_size);
+
+    // Shapes of every intermediate
+    plan->num_buffers = num_layers * BUFFERS_PER_LAYER;
+    plan->buffers = (PlanBuffer*)malloc(plan->num_buffers * sizeof(PlanBuffer));
+    plan->unshared_bytes = 0;
+    for (int i = 0; i < num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        int rows[BUFFERS_PER_LAYER] = { layer->output_size, layer->output_size, layer->output_size,
+                                        layer->output_size, layer->output_size };
+        int cols[BUFFERS_PER_LAYER] = { batch_size, batch_size, batch_size, layer->input_size, 1 };
+
+        for (int k = 0; k < BUFFERS_PER_LAYER; k++) {
+            PlanBuffer* buffer = &plan->buffers[buffer_id(i, k)];
+            size_t bytes = (size_t)rows[k] * cols[k] * sizeof(double);
+            buffer->matrix = matrix_wrap(NULL, rows[k], cols[k]);
+            buffer->bytes = (bytes + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+            buffer->offset = 0;
+            buffer->first_step = INT_MAX;
+            buffer->last_step = -1;
+            plan->unshared_bytes += buffer->bytes;
+        }
+    }
+
+    // The step list: forward, output delta, then per layer from the output
+    // down gradient, propagation and update. A layer's weights are updated
+    // after they have been used to propagate its delta, so its dW and db
+    // are dead before the next layer's are computed.
+    plan->steps = (PlanStep*)malloc((6 * num_layers + 1) * sizeof(PlanStep));
+    plan->num_steps = 0;
+    for (int i = 0; i < num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        double outputs = (double)layer->output_size * batch_size;
+        int prev = i > 0 ? buffer_id(i - 1, BUFFER_A) : OPERAND_INPUT;
+        plan_add_step(plan, PLAN_LINEAR, i, PROFILE_FORWARD, (2.0 * layer->input_size + 1.0) * outputs,
+                      buffer_id(i, BUFFER_Z), prev, OPERAND_NONE);
+        plan_add_step(plan, PLAN_ACTIVATE, i, PROFILE_FORWARD, outputs,
+                      buffer_id(i, BUFFER_A), buffer_id(i, BUFFER_Z), OPERAND_NONE);
+    }
+    plan->num_forward_steps = plan->num_steps;
+
+    plan_add_step(plan, PLAN_OUTPUT_DELTA, last, PROFILE_BACKWARD,
+                  4.0 * nn->layers[last]->output_size * batch_size,
+                  buffer_id(last, BUFFER_DELTA), buffer_id(last, BUFFER_A), buffer_id(last, BUFFER_Z));
+
+    for (int i = last; i >= 0; i--) {
+        Layer* layer = nn->layers[i];
+        double outputs = (double)layer->output_size * batch_size;
+        int prev = i > 0 ? buffer_id(i - 1, BUFFER_A) : OPERAND_INPUT;
+        plan_add_step(plan, PLAN_WEIGHT_GRAD, i, PROFILE_BACKWARD, 2.0 * layer->input_size * outputs,
+                      buffer_id(i, BUFFER_DW), buffer_id(i, BUFFER_DELTA), prev);
+        plan_add_step(plan, PLAN_BIAS_GRAD, i, PROFILE_BACKWARD, outputs,
+                      buffer_id(i, BUFFER_DB), buffer_id(i, BUFFER_DELTA), OPERAND_NONE);
+        if (i > 0) {
+            plan_add_step(plan, PLAN_PROPAGATE, i, PROFILE_BACKWARD,
+                          (2.0 * layer->output_size + 1.0) * layer->input_size * batch_size,
+                          buffer_id(i - 1, BUFFER_DELTA), buffer_id(i, BUFFER_DELTA),
+                          buffer_id(i - 1, BUFFER_Z));
+        }
+        plan_add_step(plan, PLAN_UPDATE, i, PROFILE_UPDATE, 2.0 * (layer->input_size + 1.0) * layer->output_size,
+                      OPERAND_NONE, buffer_id(i, BUFFER_DW), buffer_id(i, BUFFER_DB));
+    }
+
+    // The output activations are returned to the caller, keep them to the end
+    plan->output = operand(plan, buffer_id(last, BUFFER_A), plan->num_steps - 1);
+
+    plan->arena_bytes = assign_offsets(plan->buffers, plan->num_buffers);
+    plan->arena = (double*)aligned_alloc(ARENA_ALIGNMENT, plan->arena_bytes);
+    for (int i = 0; i < plan->num_buffers; i++) {
+        PlanBuffer* buffer = &plan->buffers[i];
+        buffer->matrix->data = (double*)((char*)plan->arena + buffer->offset);
+    }
+
+    nn->plan = plan;
+    return 0;
+}
+
+void plan_free(ExecutionPlan* plan) {
+    if (plan == NULL) return;
+    for (int i = 0; i < plan->num_buffers; i++) {
+        matrix_free(plan->buffers[i].matrix);
+    }
+    matrix_free(plan->input);
+    matrix_free(plan->target);
+    free(plan->buffers);
+    free(plan->steps);
+    free(plan->arena);
+    free(plan);
+}
+
+static double output_delta(Layer* layer, Matrix* delta, Matrix* a, Matrix* z, Matrix* target) {
+    if (layer->activation == ACTIVATION_SOFTMAX) {
+        return softmax_cross_entropy(z, target, a, delta);
+    }
+
+    double loss = mse_loss(a, target);
+    output_delta_mse(delta, a, z, target, layer->activation);
+    return loss;
+}
+
+// Runs steps [0, count); returns the loss if the output delta step ran
+static double run_steps(ExecutionPlan* plan, int count) {
+    NeuralNetwork* nn = plan->nn;
+    double scale = 1.0 / plan->batch_size;
+    double loss = 0.0;
+
+    for (int s = 0; s < count; s++) {
+        PlanStep* step = &plan->steps[s];
+        Layer* layer = nn->layers[step->layer];
+        double start = nn->profiler ? profiler_now() : 0.0;
+
+        switch (step->op) {
+            case PLAN_LINEAR: {
+                matrix_gemm(step->out, layer->weights, 0, step->in, 0, 1.0, 0.0);
+                MatrixExpr bias = matrix_expr(step->out);
+                matrix_eval(step->out, expr_add_column(&bias, layer->biases));
+                break;
+            }
+            case PLAN_ACTIVATE:
+                activation_forward(step->out, step->in, layer->activation);
+                break;
+            case PLAN_OUTPUT_DELTA:
+                loss = output_delta(layer, step->out, step->in, step->aux, plan->target);
+                break;
+            case PLAN_WEIGHT_GRAD:
+                matrix_gemm(step->out, step->in, 0, step->aux, 1, scale, 0.0);
+                break;
+            case PLAN_BIAS_GRAD:
+                for (int i = 0; i < step->in->rows; i++) {
+                    double* row = matrix_row(step->in, i);
+                    double sum = 0.0;
+                    for (int j = 0; j < step->in->cols; j++) sum += row[j];
+                    MATRIX_AT(step->out, i, 0) = sum * scale;
+                }
+                break;
+            case PLAN_PROPAGATE:
+                matrix_gemm(step->out, layer->weights, 1, step->in, 0, 1.0, 0.0);
+                multiply_activation_derivative(step->out, step->aux, nn->layers[step->layer - 1]->activation);
+                break;
+            case PLAN_UPDATE: {
+                MatrixExpr weights = matrix_expr(layer->weights);
+                expr_add_scaled(&weights, step->in, -nn->learning_rate);
+                if (layer->mask) expr_mul(&weights, layer->mask);
+                matrix_eval(layer->weights, &weights);
+                MatrixExpr biases = matrix_expr(layer->biases);
+                matrix_eval(layer->biases, expr_add_scaled(&biases, step->aux, -nn->learning_rate));
+                break;
+            }
+        }
+
+        if (nn->profiler) {
+            profiler_record(nn->profiler, step->layer, step->phase, profiler_now() - start, step->flops);
+        }
+    }
+
+    return loss;
+}
+
+// Point the plan's input header at the caller's matrix, which may be a view
+static void bind(Matrix* header, Matrix* m) {
+    header->data = m->data;
+    header->stride = m->stride;
+}
+
+Matrix* plan_forward(ExecutionPlan* plan, Matrix* input) {
+    bind(plan->input, input);
+    run_steps(plan, plan->num_forward_steps);
+    return plan->output;
+}
+
+double plan_train_step(ExecutionPlan* plan, Matrix* input, Matrix* target) {
+    bind(plan->input, input);
+    bind(plan->target, target);
+    return run_steps(plan, plan->num_steps);
+}
+
+void plan_print_summary(const ExecutionPlan* plan) {
+    printf("Compiled plan: %d steps for batches of %d, arena %.1f KB (%.1f KB without buffer reuse)\n",
+           plan->num_steps, plan->batch_size, plan->arena_bytes / 1024.0, plan->unshared_bytes / 1024.0);
+}
@@ -0,0 +1,64 @@
+#ifndef PLAN_H
+#define PLAN_H
+
+#include "neural_network.h"
+
+// One kernel call of a compiled training step
+typedef enum {
+    PLAN_LINEAR,         // z = W * a_prev + b
+    PLAN_ACTIVATE,       // a = f(z)
+    PLAN_OUTPUT_DELTA,   // Output delta and loss from a, z and the target
+    PLAN_WEIGHT_GRAD,    // dW = delta * a_prev^T / batch
+    PLAN_BIAS_GRAD,      // db = row sums of delta / batch
+    PLAN_PROPAGATE,      // delta_prev = (W^T * delta) .* f'(z_prev)
+    PLAN_UPDATE          // W -= lr * dW, b -= lr * db
+} PlanOp;
+
+typedef struct {
+    PlanOp op;
+    int layer;
+    ProfilePhase phase;
+    double flops;
+    Matrix* out;   // Operands are fixed at compile time; parameters are
+    Matrix* in;    // read from the layer on every call
+    Matrix* aux;
+} PlanStep;
+
+// An intermediate buffer placed in the arena. Buffers whose lifetimes
+// (first to last step that touches them) do not overlap share memory.
+typedef struct {
+    Matrix* matrix;
+    size_t offset;
+    size_t bytes;
+    int first_step;
+    int last_step;
+} PlanBuffer;
+
+struct ExecutionPlan {
+    NeuralNetwork* nn;
+    int batch_size;
+
+    double* arena;
+    size_t arena_bytes;
+    size_t unshared_bytes;  // What the buffers would take without reuse
+    PlanBuffer* buffers;
+    int num_buffers;
+
+    PlanStep* steps;
+    int num_steps;
+    int num_forward_steps;
+
+    Matrix* input;   // Bound to the caller's input and target on every call
+    Matrix* target;
+    Matrix* output;
+};
+
+void plan_free(ExecutionPlan* plan);
+
+// Forward pass only; the result lives in the arena until the next call
+Matrix* plan_forward(ExecutionPlan* plan, Matrix* input);
+// Forward, backward and SGD update with no allocation; returns the loss
+double plan_train_step(ExecutionPlan* plan, Matrix* input, Matrix* target);
+void plan_print_summary(const ExecutionPlan* plan);
+
+#endif
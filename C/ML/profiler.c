@@ -0,0 +1,132 @@
+#include "profiler.h"
+#include "matrix.h"
+#include "matrix_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* phase_names[PROFILE_NUM_PHASES] = { "forward", "backward", "update", "recompute" };
+
+TrainingProfiler* profiler_create(int num_layers, FILE* output, ProfileFormat format) {
+    TrainingProfiler* profiler = (TrainingProfiler*)malloc(sizeof(TrainingProfiler));
+    profiler->num_layers = num_layers;
+    profiler->seconds = (double*)calloc(num_layers * PROFILE_NUM_PHASES, sizeof(double));
+    profiler->flops = (double*)calloc(num_layers * PROFILE_NUM_PHASES, sizeof(double));
+    profiler->output = output;
+    profiler->owns_output = 0;
+    profiler->format = format;
+    profiler->header_written = 0;
+    profiler->epoch_start = profiler_now();
+    profiler->allocations_at_start = 0;
+    profiler->bytes_at_start = 0;
+    profiler->pool_hits_at_start = 0;
+    profiler->pool_misses_at_start = 0;
+    profiler->input_stall_seconds = 0.0;
+    return profiler;
+}
+
+TrainingProfiler* profiler_open(const char* path, int num_layers) {
+    FILE* output = fopen(path, "w");
+    if (!output) {
+        fprintf(stderr, "Error: Could not open profile output '%s'\n", path);
+        return NULL;
+    }
+
+    const char* ext = strrchr(path, '.');
+    ProfileFormat format = (ext && (strcmp(ext, ".json") == 0 || strcmp(ext, ".jsonl") == 0))
+                           ? PROFILE_FORMAT_JSON : PROFILE_FORMAT_CSV;
+
+    TrainingProfiler* profiler = profiler_create(num_layers, output, format);
+    profiler->owns_output = 1;
+    return profiler;
+}
+
+void profiler_free(TrainingProfiler* profiler) {
+    if (profiler == NULL) return;
+    if (profiler->owns_output) fclose(profiler->output);
+    free(profiler->seconds);
+    free(profiler->flops);
+    free(profiler);
+}
+
+double profiler_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void profiler_record(TrainingProfiler* profiler, int layer, ProfilePhase phase,
+                     double seconds, double flops) {
+    int slot = layer * PROFILE_NUM_PHASES + phase;
+    profiler->seconds[slot] += seconds;
+    profiler->flops[slot] += flops;
+}
+
+void profiler_begin_epoch(TrainingProfiler* profiler) {
+    int slots = profiler->num_layers * PROFILE_NUM_PHASES;
+    memset(profiler->seconds, 0, slots * sizeof(double));
+    memset(profiler->flops, 0, slots * sizeof(double));
+
+    MatrixAllocStats stats = matrix_alloc_stats();
+    profiler->allocations_at_start = stats.allocations;
+    profiler->bytes_at_start = stats.bytes;
+    MatrixPoolStats pool = matrix_pool_stats();
+    profiler->pool_hits_at_start = pool.hits + pool.global_hits;
+    profiler->pool_misses_at_start = pool.misses;
+    profiler->input_stall_seconds = 0.0;
+    profiler->epoch_start = profiler_now();
+}
+
+void profiler_end_epoch(TrainingProfiler* profiler, int epoch, long samples, double loss) {
+    double elapsed = profiler_now() - profiler->epoch_start;
+    MatrixAllocStats stats = matrix_alloc_stats();
+    unsigned long long allocations = stats.allocations - profiler->allocations_at_start;
+    unsigned long long bytes = stats.bytes - profiler->bytes_at_start;
+    MatrixPoolStats pool = matrix_pool_stats();
+    unsigned long long pool_hits = pool.hits + pool.global_hits - profiler->pool_hits_at_start;
+    unsigned long long pool_misses = pool.misses - profiler->pool_misses_at_start;
+    double pool_hit_rate = pool_hits + pool_misses ? (double)pool_hits / (pool_hits + pool_misses) : 0.0;
+    double samples_per_sec = elapsed > 0 ? samples / elapsed : 0.0;
+    FILE* out = profiler->output;
+
+    if (profiler->format == PROFILE_FORMAT_CSV) {
+        // One row per layer and phase; epoch totals repeat on every row
+        if (!profiler->header_written) {
+            fprintf(out, "epoch,layer,phase,seconds,flops,gflops_per_sec,"
+                         "epoch_seconds,samples,samples_per_sec,allocations,bytes_allocated,"
+                         "pool_hit_rate,pool_bytes_retained,"
+                         "input_stall_seconds,loss\n");
+            profiler->header_written = 1;
+        }
+        for (int l = 0; l < profiler->num_layers; l++) {
+            for (int p = 0; p < PROFILE_NUM_PHASES; p++) {
+                int slot = l * PROFILE_NUM_PHASES + p;
+                double seconds = profiler->seconds[slot];
+                fprintf(out, "%d,%d,%s,%.9f,%.0f,%.4f,%.6f,%ld,%.1f,%llu,%llu,%.4f,%llu,%.6f,%.8f\n",
+                        epoch + 1, l, phase_names[p], seconds, profiler->flops[slot],
+                        seconds > 0 ? profiler->flops[slot] / seconds * 1e-9 : 0.0,
+                        elapsed, samples, samples_per_sec, allocations, bytes,
+                        pool_hit_rate, pool.bytes_retained, profiler->input_stall_seconds, loss);
+            }
+        }
+    } else {
+        fprintf(out, "{\"epoch\":%d,\"seconds\":%.6f,\"samples\":%ld,\"samples_per_sec\":%.1f,"
+                     "\"allocations\":%llu,\"bytes_allocated\":%llu,\"pool_hit_rate\":%.4f,"
+                     "\"pool_bytes_retained\":%llu,\"input_stall_seconds\":%.6f,"
+                     "\"loss\":%.8f,\"layers\":[",
+                epoch + 1, elapsed, samples, samples_per_sec, allocations, bytes,
+                pool_hit_rate, pool.bytes_retained, profiler->input_stall_seconds, loss);
+        for (int l = 0; l < profiler->num_layers; l++) {
+            fprintf(out, "%s{\"layer\":%d", l ? "," : "", l);
+            for (int p = 0; p < PROFILE_NUM_PHASES; p++) {
+                int slot = l * PROFILE_NUM_PHASES + p;
+                fprintf(out, ",\"%s_seconds\":%.9f,\"%s_flops\":%.0f",
+                        phase_names[p], profiler->seconds[slot],
+                        phase_names[p], profiler->flops[slot]);
+            }
+            fprintf(out, "}");
+        }
+        fprintf(out, "]}\n");
+    }
+    fflush(out);
+}
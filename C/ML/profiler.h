@@ -0,0 +1,52 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdio.h>
+
+// Training phases timed per layer
+typedef enum {
+    PROFILE_FORWARD,
+    PROFILE_BACKWARD,
+    PROFILE_UPDATE,
+    PROFILE_RECOMPUTE,  // Forward reruns under gradient checkpointing
+    PROFILE_NUM_PHASES
+} ProfilePhase;
+
+typedef enum {
+    PROFILE_FORMAT_CSV,
+    PROFILE_FORMAT_JSON  // One JSON object per line
+} ProfileFormat;
+
+// Optional training instrumentation. Attach to NeuralNetwork::profiler;
+// the training loops then emit one record per epoch with wall time and
+// FLOPs per layer and phase, allocation volume and throughput.
+typedef struct TrainingProfiler {
+    int num_layers;
+    double* seconds;   // [layer * PROFILE_NUM_PHASES + phase], current epoch
+    double* flops;
+    FILE* output;
+    int owns_output;
+    ProfileFormat format;
+    int header_written;
+
+    double epoch_start;
+    unsigned long long allocations_at_start;
+    unsigned long long bytes_at_start;
+    unsigned long long pool_hits_at_start;    // Creates served by the matrix pool
+    unsigned long long pool_misses_at_start;
+    double input_stall_seconds;  // Filled in by nn_train_pipeline()
+} TrainingProfiler;
+
+TrainingProfiler* profiler_create(int num_layers, FILE* output, ProfileFormat format);
+// Open `path` for writing; ".json"/".jsonl" selects JSON lines, anything
+// else CSV. Returns NULL if the file cannot be created.
+TrainingProfiler* profiler_open(const char* path, int num_layers);
+void profiler_free(TrainingProfiler* profiler);
+
+double profiler_now(void);
+void profiler_record(TrainingProfiler* profiler, int layer, ProfilePhase phase,
+                     double seconds, double flops);
+void profiler_begin_epoch(TrainingProfiler* profiler);
+void profiler_end_epoch(TrainingProfiler* profiler, int epoch, long samples, double loss);
+
+#endif
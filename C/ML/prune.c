@@ -0,0 +1,284 @@
+#include "prune.h"
+#include "matrix_expr.h"
+
+static int ceil_div(int a, int b) {
+    return (a + b - 1) / b;
+}
+
+static int block_is_zero(const Matrix* m, int bi, int bj, int block_rows, int block_cols) {
+    for (int r = bi * block_rows; r < (bi + 1) * block_rows && r < m->rows; r++) {
+        for (int c = bj * block_cols; c < (bj + 1) * block_cols && c < m->cols; c++) {
+            if (MATRIX_AT(m, r, c) != 0.0) return 0;
+        }
+    }
+    return 1;
+}
+
+BsrMatrix* bsr_from_dense(const Matrix* m, int block_rows, int block_cols) {
+    BsrMatrix* a = (BsrMatrix*)malloc(sizeof(BsrMatrix));
+    a->rows = m->rows;
+    a->cols = m->cols;
+    a->block_rows = block_rows;
+    a->block_cols = block_cols;
+    a->num_block_rows = ceil_div(m->rows, block_rows);
+    int num_block_cols = ceil_div(m->cols, block_cols);
+    int block_size = block_rows * block_cols;
+
+    // Count nonzero blocks first so the arrays are allocated once
+    a->row_ptr = (int*)malloc((a->num_block_rows + 1) * sizeof(int));
+    a->row_ptr[0] = 0;
+    for (int bi = 0; bi < a->num_block_rows; bi++) {
+        int count = 0;
+        for (int bj = 0; bj < num_block_cols; bj++) {
+            count += !block_is_zero(m, bi, bj, block_rows, block_cols);
+        }
+        a->row_ptr[bi + 1] = a->row_ptr[bi] + count;
+    }
+
+    a->num_blocks = a->row_ptr[a->num_block_rows];
+    a->col_index = (int*)malloc((a->num_blocks > 0 ? a->num_blocks : 1) * sizeof(int));
+    a->values = (double*)calloc((size_t)(a->num_blocks > 0 ? a->num_blocks : 1) * block_size, sizeof(double));
+
+    // Edge blocks keep calloc's zero padding outside the matrix
+    int b = 0;
+    for (int bi = 0; bi < a->num_block_rows; bi++) {
+        for (int bj = 0; bj < num_block_cols; bj++) {
+            if (block_is_zero(m, bi, bj, block_rows, block_cols)) continue;
+
+            double* block = a->values + (size_t)b * block_size;
+            for (int r = 0; r < block_rows && bi * block_rows + r < m->rows; r++) {
+                for (int c = 0; c < block_cols && bj * block_cols + c < m->cols; c++) {
+                    block[r * block_cols + c] = MATRIX_AT(m, bi * block_rows + r, bj * block_cols + c);
+                }
+            }
+            a->col_index[b++] = bj;
+        }
+    }
+
+    return a;
+}
+
+void bsr_free(BsrMatrix* a) {
+    if (a == NULL) return;
+    free(a->row_ptr);
+    free(a->col_index);
+    free(a->values);
+    free(a);
+}
+
+size_t bsr_bytes(const BsrMatrix* a) {
+    return (size_t)a->num_blocks * a->block_rows * a->block_cols * sizeof(double) +
+           (size_t)a->num_blocks * sizeof(int) + (size_t)(a->num_block_rows + 1) * sizeof(int);
+}
+
+int bsr_multiply(Matrix* out, const BsrMatrix* a, const Matrix* x) {
+    if (x->rows != a->cols || out->rows != a->rows || out->cols != x->cols) {
+        fprintf(stderr, "Sparse multiply: (%d,%d) x (%d,%d) does not fit (%d,%d)\n",
+                a->rows, a->cols, x->rows, x->cols, out->rows, out->cols);
+        return 1;
+    }
+
+    int br = a->block_rows;
+    int bc = a->block_cols;
+    int n = x->cols;
+    matrix_fill(out, 0.0);
+
+    for (int bi = 0; bi < a->num_block_rows; bi++) {
+        int row_count = a->rows - bi * br < br ? a->rows - bi * br : br;
+        for (int b = a->row_ptr[bi]; b < a->row_ptr[bi + 1]; b++) {
+            const double* block = a->values + (size_t)b * br * bc;
+            int col0 = a->col_index[b] * bc;
+            int col_count = a->cols - col0 < bc ? a->cols - col0 : bc;
+
+            for (int r = 0; r < row_count; r++) {
+                double* out_row = matrix_row(out, bi * br + r);
+                const double* weights = block + r * bc;
+                if (n == 1) {
+                    // Matrix-vector: x is a column, one value per row
+                    double sum = 0.0;
+                    for (int c = 0; c < col_count; c++) sum += weights[c] * MATRIX_AT(x, col0 + c, 0);
+                    out_row[0] += sum;
+                } else {
+                    for (int c = 0; c < col_count; c++) {
+                        double w = weights[c];
+                        const double* x_row = matrix_row(x, col0 + c);
+                        for (int j = 0; j < n; j++) out_row[j] += w * x_row[j];
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int compare_norms(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void matrix_prune_blocks(Matrix* m, double sparsity, int block_rows, int block_cols, Matrix* mask) {
+    int num_block_rows = ceil_div(m->rows, block_rows);
+    int num_block_cols = ceil_div(m->cols, block_cols);
+    int num_blocks = num_block_rows * num_block_cols;
+    int to_prune = (int)(sparsity * num_blocks + 0.5);
+
+    double* norms = (double*)calloc(num_blocks, sizeof(double));
+    for (int i = 0; i < m->rows; i++) {
+        for (int j = 0; j < m->cols; j++) {
+            double w = MATRIX_AT(m, i, j);
+            norms[(i / block_rows) * num_block_cols + j / block_cols] += w * w;
+        }
+    }
+
+    // Blocks at or below the to_prune-th smallest norm are zeroed; ties at
+    // the threshold are broken in scan order so the count is exact
+    double threshold = -1.0;
+    if (to_prune > 0) {
+        double* sorted = (double*)malloc(num_blocks * sizeof(double));
+        memcpy(sorted, norms, num_blocks * sizeof(double));
+        qsort(sorted, num_blocks, sizeof(double), compare_norms);
+        threshold = sorted[(to_prune < num_blocks ? to_prune : num_blocks) - 1];
+        free(sorted);
+    }
+
+    int below = 0;
+    for (int b = 0; b < num_blocks; b++) below += norms[b] < threshold;
+    int ties_left = to_prune - below;
+
+    char* pruned = (char*)calloc(num_blocks, 1);
+    for (int b = 0; b < num_blocks; b++) {
+        if (norms[b] < threshold) {
+            pruned[b] = 1;
+        } else if (norms[b] == threshold && ties_left > 0) {
+            pruned[b] = 1;
+            ties_left--;
+        }
+    }
+
+    for (int i = 0; i < m->rows; i++) {
+        for (int j = 0; j < m->cols; j++) {
+            int keep = !pruned[(i / block_rows) * num_block_cols + j / block_cols];
+            if (!keep) MATRIX_AT(m, i, j) = 0.0;
+            if (mask) MATRIX_AT(mask, i, j) = keep;
+        }
+    }
+
+    free(pruned);
+    free(norms);
+}
+
+void layer_prune(Layer* layer, double sparsity, int block_rows, int block_cols) {
+    if (layer->type != LAYER_DENSE) return;
+    if (layer->mask == NULL) {
+        layer->mask = matrix_create(layer->weights->rows, layer->weights->cols);
+    }
+    matrix_prune_blocks(layer->weights, sparsity, block_rows, block_cols, layer->mask);
+}
+
+void nn_prune(NeuralNetwork* nn, double sparsity, int block_rows, int block_cols) {
+    for (int i = 0; i < nn->num_layers; i++) {
+        layer_prune(nn->layers[i], sparsity, block_rows, block_cols);
+    }
+}
+
+double nn_weight_sparsity(const NeuralNetwork* nn) {
+    long zeros = 0;
+    long total = 0;
+    for (int l = 0; l < nn->num_layers; l++) {
+        Layer* layer = nn->layers[l];
+        if (layer->type != LAYER_DENSE) continue;
+        for (int i = 0; i < layer->weights->rows; i++) {
+            for (int j = 0; j < layer->weights->cols; j++) {
+                zeros += MATRIX_AT(layer->weights, i, j) == 0.0;
+            }
+        }
+        total += (long)layer->weights->rows * layer->weights->cols;
+    }
+    return total > 0 ? (double)zeros / total : 0.0;
+}
+
+SparseNetwork* sparse_network_create(const NeuralNetwork* nn, int block_rows, int block_cols) {
+    if (nn->num_layers <= 0) {
+        fprintf(stderr, "Error: Sparse inference needs at least one layer\n");
+        return NULL;
+    }
+    for (int i = 0; i < nn->num_layers; i++) {
+        if (nn->layers[i]->type != LAYER_DENSE) {
+            fprintf(stderr, "Error: Sparse inference supports dense layers only (layer %d)\n", i);
+            return NULL;
+        }
+    }
+
+    SparseNetwork* sparse = (SparseNetwork*)malloc(sizeof(SparseNetwork));
+    sparse->num_layers = nn->num_layers;
+    sparse->weights = (BsrMatrix**)malloc(nn->num_layers * sizeof(BsrMatrix*));
+    sparse->biases = (Matrix**)malloc(nn->num_layers * sizeof(Matrix*));
+    sparse->activations = (ActivationType*)malloc(nn->num_layers * sizeof(ActivationType));
+    sparse->outputs = (Matrix**)calloc(nn->num_layers, sizeof(Matrix*));
+
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        sparse->weights[i] = bsr_from_dense(layer->weights, block_rows, block_cols);
+        sparse->biases[i] = matrix_copy(layer->biases);
+        sparse->activations[i] = layer->activation;
+    }
+    return sparse;
+}
+
+void sparse_network_free(SparseNetwork* sparse) {
+    if (sparse == NULL) return;
+    for (int i = 0; i < sparse->num_layers; i++) {
+        bsr_free(sparse->weights[i]);
+        matrix_free(sparse->biases[i]);
+        matrix_free(sparse->outputs[i]);
+    }
+    free(sparse->weights);
+    free(sparse->biases);
+    free(sparse->activations);
+    free(sparse->outputs);
+    free(sparse);
+}
+
+Matrix* sparse_network_forward(SparseNetwork* sparse, Matrix* input) {
+    if (input->rows != sparse->weights[0]->cols) {
+        fprintf(stderr, "Error: sparse_network_forward: input has %d rows, the network takes %d\n",
+                input->rows, sparse->weights[0]->cols);
+        return NULL;
+    }
+
+    Matrix* current = input;
+    for (int i = 0; i < sparse->num_layers; i++) {
+        Matrix* out = sparse->outputs[i];
+        if (out == NULL || out->cols != input->cols) {
+            matrix_free(out);
+            out = matrix_create(sparse->weights[i]->rows, input->cols);
+            sparse->outputs[i] = out;
+        }
+
+        if (bsr_multiply(out, sparse->weights[i], current)) return NULL;
+        MatrixExpr bias = matrix_expr(out);
+        matrix_eval(out, expr_add_column(&bias, sparse->biases[i]));
+        activation_forward(out, out, sparse->activations[i]);
+        current = out;
+    }
+    return current;
+}
+
+size_t sparse_network_bytes(const SparseNetwork* sparse) {
+    size_t bytes = 0;
+    for (int i = 0; i < sparse->num_layers; i++) {
+        bytes += bsr_bytes(sparse->weights[i]) + sparse->biases[i]->rows * sizeof(double);
+    }
+    return bytes;
+}
+
+size_t nn_parameter_bytes(const NeuralNetwork* nn) {
+    size_t bytes = 0;
+    for (int i = 0; i < nn->num_layers; i++) {
+        Layer* layer = nn->layers[i];
+        bytes += (size_t)layer->weights->rows * layer->weights->cols * sizeof(double);
+        if (layer->biases) bytes += layer->biases->rows * sizeof(double);
+    }
+    return bytes;
+}
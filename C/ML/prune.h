@@ -0,0 +1,61 @@
+#ifndef PRUNE_H
+#define PRUNE_H
+
+#include "neural_network.h"
+
+// Block compressed sparse row matrix: only blocks of block_rows x
+// block_cols that contain a nonzero are stored. Blocks of block row I
+// are values[row_ptr[I] .. row_ptr[I + 1]), each stored row-major, at
+// block column col_index[b]. Edge blocks are zero-padded.
+typedef struct {
+    int rows;
+    int cols;
+    int block_rows;
+    int block_cols;
+    int num_block_rows;
+    int num_blocks;      // Stored (nonzero) blocks
+    int* row_ptr;        // num_block_rows + 1 entries
+    int* col_index;      // num_blocks entries
+    double* values;      // num_blocks * block_rows * block_cols entries
+} BsrMatrix;
+
+BsrMatrix* bsr_from_dense(const Matrix* m, int block_rows, int block_cols);
+void bsr_free(BsrMatrix* a);
+size_t bsr_bytes(const BsrMatrix* a);
+// out = a * x, where x holds one column per example (GEMV for one column).
+// Returns 1 on a shape mismatch.
+int bsr_multiply(Matrix* out, const BsrMatrix* a, const Matrix* x);
+
+// Zero the blocks with the smallest L2 norm until `sparsity` (0..1) of
+// the blocks are zero. Blocks of 1 x 1 give unstructured magnitude
+// pruning; larger blocks keep the result fast in BSR form. If mask is
+// non-NULL it receives 1 for kept and 0 for pruned entries.
+void matrix_prune_blocks(Matrix* m, double sparsity, int block_rows, int block_cols, Matrix* mask);
+
+// Prune the weights of one dense layer and keep the mask on the layer
+void layer_prune(Layer* layer, double sparsity, int block_rows, int block_cols);
+// Prune every dense layer of a trained network. The pruning masks are kept
+// on the layers, so further training (fine-tuning) leaves pruned weights
+// at zero.
+void nn_prune(NeuralNetwork* nn, double sparsity, int block_rows, int block_cols);
+// Fraction of weights that are exactly zero, over all dense layers
+double nn_weight_sparsity(const NeuralNetwork* nn);
+
+// Inference-only copy of a (pruned) network with BSR weights
+typedef struct {
+    int num_layers;
+    BsrMatrix** weights;
+    Matrix** biases;
+    ActivationType* activations;
+    Matrix** outputs;    // Per-layer results, reused while the batch size is unchanged
+} SparseNetwork;
+
+SparseNetwork* sparse_network_create(const NeuralNetwork* nn, int block_rows, int block_cols);
+void sparse_network_free(SparseNetwork* sparse);
+// Result is owned by the sparse network and valid until the next call;
+// NULL if the input does not have one row per network input
+Matrix* sparse_network_forward(SparseNetwork* sparse, Matrix* input);
+size_t sparse_network_bytes(const SparseNetwork* sparse);
+size_t nn_parameter_bytes(const NeuralNetwork* nn);
+
+#endif
@@ -3,6 +3,8 @@
 #include <time.h>
 #include <math.h>
 #include "neural_network.h"
+#include "prune.h"
+#include "bf16.h"
 
 int main() {
     // Seed random number generator
@@ -85,6 +87,25 @@ int main() {
         matrix_free(test_input);
     }
 
+    // Rerun the training points with bf16 weights and activations
+    printf("\n=== bfloat16 Inference ===\n\n");
+    Bf16Network* half = bf16_network_create(nn);
+    double half_error = 0.0, max_difference = 0.0;
+    total_error = 0.0;
+    for (int i = 0; i < num_samples; i++) {
+        double predicted = matrix_get(nn_forward(nn, inputs[i]), 0, 0);
+        double half_predicted = matrix_get(bf16_network_forward(half, inputs[i]), 0, 0);
+        double actual = matrix_get(targets[i], 0, 0);
+        total_error += fabs(predicted - actual);
+        half_error += fabs(half_predicted - actual);
+        if (fabs(half_predicted - predicted) > max_difference) max_difference = fabs(half_predicted - predicted);
+    }
+    printf("Mean error: %.4f double, %.4f bf16 (max difference %.2e)\n",
+           total_error / num_samples, half_error / num_samples, max_difference);
+    printf("Model size: %zu bytes double, %zu bytes bf16\n", nn_parameter_bytes(nn),
+           bf16_network_bytes(half));
+    bf16_network_free(half);
+
     printf("\n=== Results Analysis ===\n");
     printf("The network learns to approximate the quadratic function f(x) = x^2.\n");
     printf("Errors should be small, indicating successful function approximation.\n\n");
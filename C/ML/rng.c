@@ -0,0 +1,113 @@
+#include "rng.h"
+#include <stdlib.h>
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+void rng_philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c0 = n0;
+        c1 = (uint32_t)p1;
+        c2 = n2;
+        c3 = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// 53 random bits -> [0, 1)
+static double to_unit(uint32_t hi, uint32_t lo) {
+    uint64_t bits = ((uint64_t)hi << 32) | lo;
+    return (bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Generate PHILOX_LANES consecutive blocks at once. The lanes are
+// independent, so the compiler can keep them in vector registers.
+#define PHILOX_LANES 8
+
+static void philox_lanes(uint64_t first_block, uint32_t stream_lo, uint32_t stream_hi,
+                         const uint32_t key[2], double* out, double min, double range) {
+    uint32_t c0[PHILOX_LANES], c1[PHILOX_LANES], c2[PHILOX_LANES], c3[PHILOX_LANES];
+    for (int l = 0; l < PHILOX_LANES; l++) {
+        c0[l] = (uint32_t)(first_block + l);
+        c1[l] = (uint32_t)((first_block + l) >> 32);
+        c2[l] = stream_lo;
+        c3[l] = stream_hi;
+    }
+
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        for (int l = 0; l < PHILOX_LANES; l++) {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0[l];
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2[l];
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[l] ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[l] ^ k1;
+            c0[l] = n0;
+            c1[l] = (uint32_t)p1;
+            c2[l] = n2;
+            c3[l] = (uint32_t)p0;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (int l = 0; l < PHILOX_LANES; l++) {
+        out[2 * l] = min + range * to_unit(c0[l], c1[l]);
+        out[2 * l + 1] = min + range * to_unit(c2[l], c3[l]);
+    }
+}
+
+void rng_fill_uniform(double* out, long n, uint64_t seed, uint64_t stream, uint64_t offset,
+                      double min, double max) {
+    // Each Philox block yields two doubles: value v comes from block v / 2
+    uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+    uint32_t counter[4] = { 0, 0, (uint32_t)stream, (uint32_t)(stream >> 32) };
+    uint32_t block[4];
+    double range = max - min;
+    long k = 0;
+
+    while (k < n) {
+        uint64_t value = offset + k;
+
+        // Whole groups of blocks take the batched path
+        if (value % 2 == 0 && n - k >= 2 * PHILOX_LANES) {
+            philox_lanes(value / 2, counter[2], counter[3], key, out + k, min, range);
+            k += 2 * PHILOX_LANES;
+            continue;
+        }
+
+        uint64_t block_index = value / 2;
+        counter[0] = (uint32_t)block_index;
+        counter[1] = (uint32_t)(block_index >> 32);
+        rng_philox4x32(counter, key, block);
+
+        if (value % 2 == 0) {
+            out[k++] = min + range * to_unit(block[0], block[1]);
+            if (k == n) break;
+        }
+        out[k++] = min + range * to_unit(block[2], block[3]);
+    }
+}
+
+uint64_t rng_seed_from_rand(void) {
+    uint64_t seed = 0;
+    for (int i = 0; i < 4; i++) {
+        seed = (seed << 16) ^ (uint64_t)(rand() & 0xFFFF);
+    }
+    return seed;
+}
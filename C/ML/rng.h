@@ -0,0 +1,21 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random
+// Numbers: As Easy as 1, 2, 3"). Output is a pure function of
+// (seed, stream, index), so any range of a sequence can be generated
+// independently and in any order without shared state.
+void rng_philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+// Fill out[0..n) with uniform values in [min, max): element k is value
+// number (offset + k) of the (seed, stream) sequence
+void rng_fill_uniform(double* out, long n, uint64_t seed, uint64_t stream, uint64_t offset,
+                      double min, double max);
+
+// Derive a seed from libc rand(), so callers that only use srand() still
+// get varied but srand-reproducible sequences
+uint64_t rng_seed_from_rand(void);
+
+#endif
@@ -3,13 +3,26 @@
 #include <string.h>
 #include <ctype.h>
 #include <time.h>
+#include <math.h>
 #include "neural_network.h"
 #include "json_parser.h"
+#include "dataset_cache.h"
+#include "pipeline.h"
+#include "plan.h"
+#include "checkpoint.h"
+#include "evaluate.h"
+#include "prune.h"
+#include "bf16.h"
 
 #define MAX_VOCAB_SIZE 100
 #define MAX_TEXT_LENGTH 1000
 #define MAX_WORD_LENGTH 50
 
+#define BATCH_SIZE 4
+
+#define TRAINING_DATA_FILE "sentiment_training_data.json"
+#define TRAINING_CACHE_FILE "sentiment_training_data.dscache"
+
 // Vocabulary for sentiment analysis
 typedef struct {
     char** words;
@@ -115,6 +128,52 @@ Matrix* text_to_features(const char* text, Vocabulary* vocab) {
     return features;
 }
 
+// Hash of the vocabulary, so a cache built with different features is rejected
+uint64_t vocabulary_signature(Vocabulary* vocab) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < vocab->size; i++) {
+        for (const char* p = vocab->words[i]; ; p++) {
+            hash ^= (unsigned char)*p;
+            hash *= 1099511628211ULL;
+            if (*p == '\0') break;
+        }
+    }
+    return hash;
+}
+
+// Parse and featurize the JSON training data, then write the binary cache
+int build_training_cache(Vocabulary* vocab, uint64_t signature) {
+    printf("Loading training data from JSON file...\n");
+    TrainingDataset* dataset = load_training_data(TRAINING_DATA_FILE);
+    if (!dataset) return 1;
+
+    int num_samples = dataset->count;
+    printf("Loaded %d training examples\n", num_samples);
+
+    Matrix** inputs = (Matrix**)malloc(num_samples * sizeof(Matrix*));
+    Matrix** targets = (Matrix**)malloc(num_samples * sizeof(Matrix*));
+
+    printf("Converting training data to features...\n");
+    for (int i = 0; i < num_samples; i++) {
+        inputs[i] = text_to_features(dataset->examples[i].text, vocab);
+        targets[i] = matrix_create(1, 1);
+        matrix_set(targets[i], 0, 0, dataset->examples[i].label);
+    }
+
+    printf("Writing feature cache '%s'...\n", TRAINING_CACHE_FILE);
+    int result = dataset_cache_write(TRAINING_CACHE_FILE, dataset, inputs, targets,
+                                     TRAINING_DATA_FILE, signature);
+
+    for (int i = 0; i < num_samples; i++) {
+        matrix_free(inputs[i]);
+        matrix_free(targets[i]);
+    }
+    free(inputs);
+    free(targets);
+    free_training_dataset(dataset);
+    return result;
+}
+
 int main() {
     srand(time(NULL));
 
@@ -125,29 +184,29 @@ int main() {
     printf("Vocabulary size: %d words\n", vocab->size);
     printf("Positive words (0-14), Negative words (15-29)\n\n");
 
-    // Load training data from JSON file
-    printf("Loading training data from JSON file...\n");
-    TrainingDataset* dataset = load_training_data("sentiment_training_data.json");
+    // Map the featurized training data, building the cache on first run
+    uint64_t signature = vocabulary_signature(vocab);
+    DatasetCache* cache = dataset_cache_open(TRAINING_CACHE_FILE, TRAINING_DATA_FILE, signature);
+    if (!cache) {
+        if (build_training_cache(vocab, signature) == 0) {
+            cache = dataset_cache_open(TRAINING_CACHE_FILE, TRAINING_DATA_FILE, signature);
+        }
+    } else {
+        printf("Using cached features from '%s'\n", TRAINING_CACHE_FILE);
+    }
 
-    if (!dataset) {
+    if (!cache) {
         fprintf(stderr, "Error: Failed to load training data\n");
         free_vocabulary(vocab);
         return 1;
     }
 
-    int num_samples = dataset->count;
-    printf("Loaded %d training examples\n\n", num_samples);
-
-    // Convert training data to feature matrices
-    Matrix** inputs = (Matrix**)malloc(num_samples * sizeof(Matrix*));
-    Matrix** targets = (Matrix**)malloc(num_samples * sizeof(Matrix*));
-
-    printf("Converting training data to features...\n");
-    for (int i = 0; i < num_samples; i++) {
-        inputs[i] = text_to_features(dataset->examples[i].text, vocab);
-        targets[i] = matrix_create(1, 1);
-        matrix_set(targets[i], 0, 0, dataset->examples[i].label);
-    }
+    // Hold out the last fifth of the examples for validation
+    int num_samples = cache->count;
+    int num_val = num_samples / 5;
+    int num_train = num_samples - num_val;
+    printf("%d training examples ready (%d train, %d validation)\n\n",
+           num_samples, num_train, num_val);
 
     // Create neural network
     // Architecture: vocab_size (30) -> 16 -> 8 -> 1
@@ -158,37 +217,107 @@ int main() {
     nn_add_layer(nn, 0, vocab->size, 16, ACTIVATION_RELU);
     nn_add_layer(nn, 1, 16, 8, ACTIVATION_RELU);
     nn_add_layer(nn, 2, 8, 1, ACTIVATION_SIGMOID);
-    nn->learning_rate = 0.1;
+    nn->learning_rate = 0.3;
 
-    // Train the network
-    printf("Training for 500 epochs...\n\n");
-    nn_train(nn, inputs, targets, num_samples, 500);
+    // Full batches run through a fixed buffer schedule; the short final
+    // batch of an epoch takes the regular path
+    if (nn_compile(nn, BATCH_SIZE) == 0) {
+        plan_print_summary(nn->plan);
+        printf("\n");
+    }
+
+    // Set NN_PROFILE=<file>.csv or <file>.jsonl to record per-epoch timings
+    const char* profile_path = getenv("NN_PROFILE");
+    if (profile_path) {
+        nn->profiler = profiler_open(profile_path, nn->num_layers);
+    }
+
+    // Set NN_CHECKPOINT=<file> to checkpoint every 50 epochs in the
+    // background and to resume from that file after an interruption
+    const char* checkpoint_path = getenv("NN_CHECKPOINT");
+    if (checkpoint_path) {
+        nn->checkpointer = checkpointer_create(checkpoint_path, 50);
+        int resumed = nn->checkpointer ? checkpointer_resume(nn->checkpointer, nn) : 0;
+        if (resumed > 0) printf("Resuming from '%s' after epoch %d\n\n", checkpoint_path, resumed);
+    }
+
+    // Stop once the validation loss has not improved for 50 epochs and
+    // keep the weights of the best epoch
+    Matrix train_inputs, train_targets, val_inputs, val_targets;
+    dataset_cache_view_batch(cache, 0, num_train, &train_inputs, &train_targets);
+    dataset_cache_view_batch(cache, num_train, num_val, &val_inputs, &val_targets);
+    nn->early_stopping = early_stopping_create(&val_inputs, &val_targets, 50);
+    if (!nn->early_stopping) {
+        fprintf(stderr, "Error: Too few examples for a validation split\n");
+        dataset_cache_close(cache);
+        profiler_free(nn->profiler);
+        checkpointer_free(nn->checkpointer);
+        free_vocabulary(vocab);
+        nn_free(nn);
+        return 1;
+    }
+
+    // Train the network on shuffled mini-batches assembled by background
+    // workers, so reading the mapped features overlaps with compute
+    InputPipeline* pipeline = pipeline_create(dataset_cache_fetch, cache, num_train,
+                                              cache->input_size, cache->target_size,
+                                              BATCH_SIZE, 64, 4, 2, (uint64_t)time(NULL));
+
+    printf("Training for up to 500 epochs (batch size %d, 2 input workers)...\n\n", BATCH_SIZE);
+    nn_train_pipeline(nn, pipeline, 500);
+    printf("Total input stall: %.3f ms\n", pipeline->total_stall_seconds * 1000.0);
+    pipeline_free(pipeline);
+
+    EarlyStopping* stopping = nn->early_stopping;
+    if (stopping->stopped_epoch >= 0) {
+        printf("Stopped early after epoch %d; ", stopping->stopped_epoch + 1);
+    }
+    printf("Best validation loss %.6f at epoch %d (%.3f ms spent evaluating)\n",
+           stopping->best_loss, stopping->best_epoch + 1, stopping->evaluation_seconds * 1000.0);
 
     printf("\n=== Testing on Training Data ===\n\n");
 
-    // Test on training data
-    int correct = 0;
-    for (int i = 0; i < num_samples; i++) {
-        Matrix* output = nn_forward(nn, inputs[i]);
+    // Show every fifth training example
+    Matrix sample;
+    for (int i = 0; i < num_train; i += 5) {
+        dataset_cache_view_batch(cache, i, 1, &sample, NULL);
+        Matrix* output = nn_forward(nn, &sample);
         double prediction = matrix_get(output, 0, 0);
-        double actual = dataset->examples[i].label;
+        double actual = dataset_cache_label(cache, i);
         int predicted_class = prediction >= 0.5 ? 1 : 0;
         int actual_class = actual >= 0.5 ? 1 : 0;
 
-        if (predicted_class == actual_class) correct++;
-
-        if (i % 5 == 0) {
-            printf("Sample %d: \"%s\"\n", i, dataset->examples[i].text);
-            printf("  Prediction: %.4f (%s), Actual: %.0f (%s)\n\n",
-                   prediction,
-                   predicted_class ? "POSITIVE" : "NEGATIVE",
-                   actual,
-                   actual_class ? "POSITIVE" : "NEGATIVE");
-        }
+        printf("Sample %d: \"%s\"\n", i, dataset_cache_text(cache, i));
+        printf("  Prediction: %.4f (%s), Actual: %.0f (%s)\n\n",
+               prediction,
+               predicted_class ? "POSITIVE" : "NEGATIVE",
+               actual,
+               actual_class ? "POSITIVE" : "NEGATIVE");
     }
 
-    printf("Training Accuracy: %d/%d (%.1f%%)\n\n", correct, num_samples,
-           100.0 * correct / num_samples);
+    // Batched, multi-threaded evaluation of both splits
+    EvalResult train_result = nn_evaluate(nn, &train_inputs, &train_targets, 64, 0);
+    EvalResult val_result = nn_evaluate(nn, &val_inputs, &val_targets, 64, 0);
+    printf("Training Accuracy: %.1f%% (%d examples, loss %.6f)\n",
+           train_result.accuracy * 100, train_result.count, train_result.loss);
+    printf("Validation Accuracy: %.1f%% (%d examples, loss %.6f)\n",
+           val_result.accuracy * 100, val_result.count, val_result.loss);
+
+    // The same validation pass with bf16 weights and activations
+    Bf16Network* half = bf16_network_create(nn);
+    Matrix* half_output = bf16_network_forward(half, &val_inputs);
+    int half_correct = 0;
+    double max_difference = 0.0;
+    Matrix* reference = nn_forward(nn, &val_inputs);
+    for (int j = 0; j < num_val; j++) {
+        double prediction = matrix_get(half_output, 0, j);
+        if ((prediction >= 0.5) == (matrix_get(&val_targets, 0, j) >= 0.5)) half_correct++;
+        double difference = fabs(prediction - matrix_get(reference, 0, j));
+        if (difference > max_difference) max_difference = difference;
+    }
+    printf("bf16 Validation Accuracy: %.1f%% (max output difference %.2e, %zu vs %zu parameter bytes)\n\n",
+           100.0 * half_correct / num_val, max_difference, bf16_network_bytes(half), nn_parameter_bytes(nn));
+    bf16_network_free(half);
 
     // Test on new examples
     printf("=== Testing on New Data ===\n\n");
@@ -207,7 +336,7 @@ int main() {
     };
 
     int num_tests = 6;
-    correct = 0;
+    int correct = 0;
 
     for (int i = 0; i < num_tests; i++) {
         Matrix* test_input = text_to_features(test_texts[i], vocab);
@@ -242,13 +371,10 @@ int main() {
     printf("  // sentiment >= 0.5: positive, < 0.5: negative\n\n");
 
     // Cleanup
-    for (int i = 0; i < num_samples; i++) {
-        matrix_free(inputs[i]);
-        matrix_free(targets[i]);
-    }
-    free(inputs);
-    free(targets);
-    free_training_dataset(dataset);
+    dataset_cache_close(cache);
+    profiler_free(nn->profiler);
+    checkpointer_free(nn->checkpointer);
+    early_stopping_free(nn->early_stopping);
     free_vocabulary(vocab);
     nn_free(nn);
 
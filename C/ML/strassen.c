@@ -0,0 +1,137 @@
+#include "strassen.h"
+#include "gemm.h"
+
+// Stack of scratch matrices; each recursion level takes three and gives
+// them back on return
+typedef struct {
+    double* data;
+    size_t size;
+    size_t used;
+} StrassenArena;
+
+static Matrix arena_matrix(StrassenArena* arena, int rows, int cols) {
+    Matrix m = { rows, cols, cols, arena->data + arena->used, 0 };
+    arena->used += (size_t)rows * cols;
+    return m;
+}
+
+static int recurses(int m, int k, int n, int cutoff) {
+    return m > cutoff && k > cutoff && n > cutoff;
+}
+
+size_t strassen_scratch_size(int m, int k, int n, int cutoff) {
+    size_t total = 0;
+    while (recurses(m, k, n, cutoff)) {
+        m /= 2;
+        k /= 2;
+        n /= 2;
+        total += (size_t)m * k + (size_t)k * n + (size_t)m * n;
+    }
+    return total;
+}
+
+// c = a + sign * b, element-wise; c may alias a or b
+static void add(Matrix* c, const Matrix* a, const Matrix* b, double sign) {
+    for (int i = 0; i < c->rows; i++) {
+        const double* x = matrix_row(a, i);
+        const double* y = matrix_row(b, i);
+        double* out = matrix_row(c, i);
+        for (int j = 0; j < c->cols; j++) out[j] = x[j] + sign * y[j];
+    }
+}
+
+static void strassen(Matrix* c, const Matrix* a, const Matrix* b, int cutoff, StrassenArena* arena) {
+    int m = c->rows, k = a->cols, n = c->cols;
+    if (!recurses(m, k, n, cutoff)) {
+        matrix_gemm(c, (Matrix*)a, 0, (Matrix*)b, 0, 1.0, 0.0);
+        return;
+    }
+
+    int m2 = m / 2, k2 = k / 2, n2 = n / 2;
+    Matrix a11 = matrix_view(a, 0, 0, m2, k2), a12 = matrix_view(a, 0, k2, m2, k2);
+    Matrix a21 = matrix_view(a, m2, 0, m2, k2), a22 = matrix_view(a, m2, k2, m2, k2);
+    Matrix b11 = matrix_view(b, 0, 0, k2, n2), b12 = matrix_view(b, 0, n2, k2, n2);
+    Matrix b21 = matrix_view(b, k2, 0, k2, n2), b22 = matrix_view(b, k2, n2, k2, n2);
+    Matrix c11 = matrix_view(c, 0, 0, m2, n2), c12 = matrix_view(c, 0, n2, m2, n2);
+    Matrix c21 = matrix_view(c, m2, 0, m2, n2), c22 = matrix_view(c, m2, n2, m2, n2);
+
+    size_t mark = arena->used;
+    Matrix x = arena_matrix(arena, m2, k2);
+    Matrix y = arena_matrix(arena, k2, n2);
+    Matrix z = arena_matrix(arena, m2, n2);
+
+    // Winograd's schedule with three temporaries; products land in the
+    // quadrants of c and are combined in place
+    add(&x, &a11, &a21, -1.0);          // S3 = A11 - A21
+    add(&y, &b22, &b12, -1.0);          // T3 = B22 - B12
+    strassen(&c21, &x, &y, cutoff, arena);  // P7 = S3 * T3
+    add(&x, &a21, &a22, 1.0);           // S1 = A21 + A22
+    add(&y, &b12, &b11, -1.0);          // T1 = B12 - B11
+    strassen(&c22, &x, &y, cutoff, arena);  // P5 = S1 * T1
+    add(&x, &x, &a11, -1.0);            // S2 = S1 - A11
+    add(&y, &b22, &y, -1.0);            // T2 = B22 - T1
+    strassen(&c12, &x, &y, cutoff, arena);  // P6 = S2 * T2
+    add(&x, &a12, &x, -1.0);            // S4 = A12 - S2
+    strassen(&c11, &x, &b22, cutoff, arena);  // P3 = S4 * B22
+    strassen(&z, &a11, &b11, cutoff, arena);  // P1 = A11 * B11
+    add(&c12, &z, &c12, 1.0);           // U2 = P1 + P6
+    add(&c21, &c12, &c21, 1.0);         // U3 = U2 + P7
+    add(&c12, &c12, &c22, 1.0);         // U4 = U2 + P5
+    add(&c22, &c21, &c22, 1.0);         // C22 = U3 + P5
+    add(&c12, &c12, &c11, 1.0);         // C12 = U4 + P3
+    add(&y, &y, &b21, -1.0);            // T4 = T2 - B21
+    strassen(&c11, &a22, &y, cutoff, arena);  // P4 = A22 * T4
+    add(&c21, &c21, &c11, -1.0);        // C21 = U3 - P4
+    strassen(&c11, &a12, &b21, cutoff, arena);  // P2 = A12 * B21
+    add(&c11, &c11, &z, 1.0);           // C11 = P1 + P2
+    arena->used = mark;
+
+    // Peel odd dimensions: the last column of depth, then the last row
+    // and column of c
+    if (k % 2) {
+        Matrix c_even = matrix_view(c, 0, 0, 2 * m2, 2 * n2);
+        Matrix a_last = matrix_view(a, 0, k - 1, 2 * m2, 1);
+        Matrix b_last = matrix_view(b, k - 1, 0, 1, 2 * n2);
+        matrix_gemm(&c_even, &a_last, 0, &b_last, 0, 1.0, 1.0);
+    }
+    if (n % 2) {
+        Matrix c_col = matrix_view(c, 0, n - 1, m, 1);
+        Matrix b_col = matrix_view(b, 0, n - 1, k, 1);
+        matrix_gemm(&c_col, (Matrix*)a, 0, &b_col, 0, 1.0, 0.0);
+    }
+    if (m % 2) {
+        Matrix c_row = matrix_view(c, m - 1, 0, 1, 2 * n2);
+        Matrix a_row = matrix_view(a, m - 1, 0, 1, k);
+        Matrix b_even = matrix_view(b, 0, 0, k, 2 * n2);
+        matrix_gemm(&c_row, &a_row, 0, &b_even, 0, 1.0, 0.0);
+    }
+}
+
+int matrix_gemm_strassen(Matrix* c, const Matrix* a, const Matrix* b, int cutoff) {
+    if (a->cols != b->rows || c->rows != a->rows || c->cols != b->cols) {
+        fprintf(stderr, "Error: matrix_gemm_strassen: (%d,%d) x (%d,%d) into (%d,%d)\n",
+                a->rows, a->cols, b->rows, b->cols, c->rows, c->cols);
+        return 1;
+    }
+    if (cutoff <= 0) cutoff = gemm_config().strassen_cutoff;
+    // Below 16 the halves are too small for the kernel to pay for the additions
+    if (cutoff < 16) cutoff = 16;
+
+    StrassenArena arena = { NULL, strassen_scratch_size(c->rows, a->cols, c->cols, cutoff), 0 };
+    if (arena.size > 0) arena.data = (double*)malloc(arena.size * sizeof(double));
+    strassen(c, a, b, cutoff, &arena);
+    free(arena.data);
+    return 0;
+}
+
+Matrix* matrix_multiply_strassen(Matrix* a, Matrix* b) {
+    if (a->cols != b->rows) {
+        fprintf(stderr, "Matrix dimensions incompatible for multiplication: (%d,%d) x (%d,%d)\n",
+                a->rows, a->cols, b->rows, b->cols);
+        return NULL;
+    }
+
+    Matrix* result = matrix_create(a->rows, b->cols);
+    matrix_gemm_strassen(result, a, b, 0);
+    return result;
+}
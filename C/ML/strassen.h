@@ -0,0 +1,22 @@
+#ifndef STRASSEN_H
+#define STRASSEN_H
+
+#include "matrix.h"
+
+// c = a * b by Strassen-Winograd recursion: 7 half-size products and 15
+// additions per level instead of 8 products, O(n^2.81) overall. Halves
+// are views, so nothing is copied; odd rows, columns and depth are peeled
+// off and finished with matrix_gemm(). Recursion stops once a dimension
+// is at most `cutoff` (0: the tuned GemmConfig.strassen_cutoff), where
+// the blocked kernel is faster. Scratch comes from one arena allocated up
+// front. Returns 1 on a shape mismatch.
+//
+// The error bound grows faster with depth than the classical one (see
+// strassen_bench), so this is an explicit opt-in, not a matrix_gemm() path.
+int matrix_gemm_strassen(Matrix* c, const Matrix* a, const Matrix* b, int cutoff);
+Matrix* matrix_multiply_strassen(Matrix* a, Matrix* b);
+
+// Doubles of scratch the recursion needs for these shapes
+size_t strassen_scratch_size(int m, int k, int n, int cutoff);
+
+#endif
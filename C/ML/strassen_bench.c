@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gemm.h"
+#include "strassen.h"
+
+#define NUM_SAMPLES 256  // Entries checked against the extended-precision reference
+#define MIN_SPEEDUP 1.03  // Below this, Strassen is counted as no faster
+
+static int num_repeats = 3;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Best of a few runs; cutoff 0 times the classical kernel
+static double time_multiply(Matrix* c, Matrix* a, Matrix* b, int cutoff) {
+    double best = 1e30;
+    for (int r = 0; r < num_repeats; r++) {
+        double start = now_seconds();
+        if (cutoff == 0) {
+            matrix_gemm(c, a, 0, b, 0, 1.0, 0.0);
+        } else {
+            matrix_gemm_strassen(c, a, b, cutoff);
+        }
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+// Largest error of sampled entries against a long double dot product,
+// relative to sum |a_ip| |b_pj| (the scale of the classical error bound)
+static double sampled_error(const Matrix* c, const Matrix* a, const Matrix* b) {
+    double worst = 0.0;
+    unsigned seed = 12345;
+    for (int s = 0; s < NUM_SAMPLES; s++) {
+        int i = rand_r(&seed) % c->rows;
+        int j = rand_r(&seed) % c->cols;
+        long double exact = 0.0L;
+        double scale = 0.0;
+        for (int p = 0; p < a->cols; p++) {
+            exact += (long double)MATRIX_AT(a, i, p) * MATRIX_AT(b, p, j);
+            scale += fabs(MATRIX_AT(a, i, p) * MATRIX_AT(b, p, j));
+        }
+        double error = fabs((double)((long double)MATRIX_AT(c, i, j) - exact)) / scale;
+        if (error > worst) worst = error;
+    }
+    return worst;
+}
+
+static void usage(const char* program) {
+    printf("Usage: %s [--quick] [--max N]\n", program);
+    printf("  --quick  one run per timing\n");
+    printf("  --max N  largest matrix size (default 2048; 4096 takes minutes)\n");
+}
+
+int main(int argc, char** argv) {
+    int max_size = 2048;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            num_repeats = 1;
+        } else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            max_size = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    static const int cutoffs[] = { 64, 128, 256, 512, 1024, 2048 };
+    int num_cutoffs = sizeof(cutoffs) / sizeof(cutoffs[0]);
+    GemmConfig config = gemm_config();
+
+    printf("=== Strassen-Winograd vs. Blocked GEMM ===\n\n");
+    printf("Square products c = a * b, best of %d runs; error is the largest of %d sampled\n",
+           num_repeats, NUM_SAMPLES);
+    printf("entries relative to sum |a||b|, against a long double reference\n\n");
+    printf("%6s %10s %10s %8s %8s %8s %10s %10s\n", "n", "gemm (s)", "best (s)", "cutoff", "levels",
+           "speedup", "gemm err", "str err");
+
+    int crossover = 0;
+    int best_cutoff_at_max = 0;
+    for (int n = 256; n <= max_size; n *= 2) {
+        Matrix* a = matrix_create(n, n);
+        Matrix* b = matrix_create(n, n);
+        Matrix* c = matrix_create(n, n);
+        matrix_randomize_seeded(a, -1.0, 1.0, 1, n);
+        matrix_randomize_seeded(b, -1.0, 1.0, 2, n);
+
+        // Touch c once so page faults are not charged to the first timing
+        matrix_gemm(c, a, 0, b, 0, 1.0, 0.0);
+        double classical = time_multiply(c, a, b, 0);
+        double classical_error = sampled_error(c, a, b);
+
+        double best = classical;
+        int best_cutoff = 0;
+        for (int i = 0; i < num_cutoffs && cutoffs[i] < n; i++) {
+            double seconds = time_multiply(c, a, b, cutoffs[i]);
+            if (seconds < best) {
+                best = seconds;
+                best_cutoff = cutoffs[i];
+            }
+        }
+
+        // Error at the fastest cutoff, or one level if none was faster
+        int error_cutoff = best_cutoff ? best_cutoff : n / 2;
+        matrix_gemm_strassen(c, a, b, error_cutoff);
+        double strassen_error = sampled_error(c, a, b);
+        int levels = 0;
+        for (int size = n; size > error_cutoff; size /= 2) levels++;
+
+        double speedup = classical / best;
+        printf("%6d %10.4f %10.4f %8d %8d %7.2fx %10.2e %10.2e\n", n, classical, best,
+               best_cutoff, levels, speedup, classical_error, strassen_error);
+        if (speedup >= MIN_SPEEDUP && crossover == 0) crossover = n;
+        if (speedup < MIN_SPEEDUP) crossover = 0;
+        best_cutoff_at_max = speedup >= MIN_SPEEDUP ? best_cutoff : 0;
+
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(c);
+    }
+
+    printf("\n");
+    if (crossover) {
+        printf("Strassen is faster from n = %d; best cutoff at the largest size: %d\n",
+               crossover, best_cutoff_at_max);
+    } else {
+        printf("Strassen is not faster up to n = %d\n", max_size);
+    }
+    printf("Configured strassen_cutoff: %d (tune with matrix_autotune)\n", config.strassen_cutoff);
+    return 0;
+}
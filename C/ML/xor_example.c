@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include "neural_network.h"
+#include "bf16.h"
 
 int main() {
     // Seed random number generator
@@ -64,15 +65,19 @@ int main() {
 
     printf("\n=== Testing the trained network ===\n\n");
 
-    // Test the network
+    // Test the network, alongside a bf16 copy of it
+    Bf16Network* half = bf16_network_create(nn);
     for (int i = 0; i < num_samples; i++) {
         Matrix* output = nn_forward(nn, inputs[i]);
-        printf("Input: [%.0f, %.0f] -> Output: %.4f (Target: %.0f)\n",
+        Matrix* half_output = bf16_network_forward(half, inputs[i]);
+        printf("Input: [%.0f, %.0f] -> Output: %.4f, bf16: %.4f (Target: %.0f)\n",
                matrix_get(inputs[i], 0, 0),
                matrix_get(inputs[i], 1, 0),
                matrix_get(output, 0, 0),
+               matrix_get(half_output, 0, 0),
                matrix_get(targets[i], 0, 0));
     }
+    bf16_network_free(half);
 
     printf("\n=== Results Analysis ===\n");
     printf("The network should output values close to 0 or 1.\n");
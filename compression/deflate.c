@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
 
 // DEFLATE constants
 #define WINDOW_SIZE 32768      // 32KB sliding window
@@ -19,6 +20,25 @@
 #define DIST_CODES 30          // Number of distance codes
 #define MAX_CODES (LITERALS + 1 + LENGTH_CODES)  // 286 codes
 
+// Length and distance code bases and extra bits (RFC 1951, 3.2.5)
+static const uint16_t length_base[LENGTH_CODES] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[LENGTH_CODES] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[DIST_CODES] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[DIST_CODES] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
 // Bit buffer structure
 typedef struct {
     uint32_t bits;
@@ -83,6 +103,17 @@ void flush_bits(BitBuffer *bb) {
     }
 }
 
+// Huffman codes are packed starting from their most significant bit,
+// unlike every other field, so they are written reversed
+static inline uint32_t reverse_bits(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; i++) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    return reversed;
+}
+
 // Hash function for LZ77
 static inline uint32_t hash3(const unsigned char *data) {
     return ((data[0] << 10) ^ (data[1] << 5) ^ data[2]) & HASH_MASK;
@@ -176,15 +207,6 @@ LZ77Token* lz77_compress(const unsigned char *data, size_t size, size_t *token_c
 
 // Convert length to DEFLATE length code
 void get_length_code(int length, int *code, int *extra_bits, int *extra_value) {
-    static const int length_base[] = {
-        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
-        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
-    };
-    static const int length_extra[] = {
-        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
-        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
-    };
-
     for (int i = 0; i < LENGTH_CODES; i++) {
         if (length_base[i] <= length &&
             (i == LENGTH_CODES - 1 || length < length_base[i + 1])) {
@@ -198,16 +220,6 @@ void get_length_code(int length, int *code, int *extra_bits, int *extra_value) {
 
 // Convert distance to DEFLATE distance code
 void get_distance_code(int distance, int *code, int *extra_bits, int *extra_value) {
-    static const int dist_base[] = {
-        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
-        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
-        8193, 12289, 16385, 24577
-    };
-    static const int dist_extra[] = {
-        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
-        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
-    };
-
     for (int i = 0; i < DIST_CODES; i++) {
         if (dist_base[i] <= distance &&
             (i == DIST_CODES - 1 || distance < dist_base[i + 1])) {
@@ -402,9 +414,9 @@ int deflate_compress(const char *input_filename, const char *output_filename) {
             // Literal byte - use fixed Huffman code
             int lit = tokens[i].literal;
             if (lit <= 143) {
-                write_bits(bb, 0x30 + lit, 8);  // Reversed: 0x30 = 00110000
+                write_bits(bb, reverse_bits(0x30 + lit, 8), 8);
             } else {
-                write_bits(bb, 0x190 + (lit - 144), 9);  // Reversed: 0x190 = 110010000
+                write_bits(bb, reverse_bits(0x190 + (lit - 144), 9), 9);
             }
         } else {
             // Length/distance pair
@@ -413,9 +425,9 @@ int deflate_compress(const char *input_filename, const char *output_filename) {
 
             // Write length code
             if (len_code <= 279) {
-                write_bits(bb, len_code - 256, 7);
+                write_bits(bb, reverse_bits(len_code - 256, 7), 7);
             } else {
-                write_bits(bb, 0xC0 + (len_code - 280), 8);
+                write_bits(bb, reverse_bits(0xC0 + (len_code - 280), 8), 8);
             }
 
             // Write length extra bits
@@ -427,14 +439,8 @@ int deflate_compress(const char *input_filename, const char *output_filename) {
             int dist_code = 0, dist_extra_bits = 0, dist_extra_value = 0;
             get_distance_code(tokens[i].distance, &dist_code, &dist_extra_bits, &dist_extra_value);
 
-            // Distance codes are 5 bits, reversed
-            uint8_t reversed_dist = 0;
-            for (int j = 0; j < 5; j++) {
-                if (dist_code & (1 << j)) {
-                    reversed_dist |= (1 << (4 - j));
-                }
-            }
-            write_bits(bb, reversed_dist, 5);
+            // Distance codes are 5 bits
+            write_bits(bb, reverse_bits(dist_code, 5), 5);
 
             // Write distance extra bits
             if (dist_extra_bits > 0) {
@@ -484,10 +490,470 @@ int deflate_compress(const char *input_filename, const char *output_filename) {
     return 0;
 }
 
+// ---- Inflate (decompression) ----
+
+#define LITLEN_SYMBOLS 288       // 286 used, plus 2 reserved in the fixed code
+#define PRECODE_SYMBOLS 19       // Code length alphabet of dynamic blocks
+#define LITLEN_TABLE_BITS 10     // Primary table index bits
+#define DIST_TABLE_BITS 8
+#define PRECODE_TABLE_BITS 7     // Code length codes are at most 7 bits
+#define INVALID_SYMBOL 0xFFFF    // Unused slot of an incomplete code
+
+// Lookup table sizes: the primary table plus, at worst, one subtable
+// (indexed by the bits past table_bits of the longest code) per symbol
+#define LITLEN_TABLE_SIZE ((1 << LITLEN_TABLE_BITS) + LITLEN_SYMBOLS * (1 << (MAX_BITS - LITLEN_TABLE_BITS)))
+#define DIST_TABLE_SIZE ((1 << DIST_TABLE_BITS) + 32 * (1 << (MAX_BITS - DIST_TABLE_BITS)))
+#define PRECODE_TABLE_SIZE (1 << PRECODE_TABLE_BITS)
+
+// Entry of a two-level decoding table. The primary table is indexed by
+// the next table_bits input bits; codes longer than that go through a
+// link to a subtable indexed by the bits that follow.
+typedef struct {
+    uint16_t symbol;    // Decoded symbol, or subtable offset for a link
+    uint8_t length;     // Bits consumed at this level
+    uint8_t sub_bits;   // Nonzero for a link: subtable index bits
+} HuffEntry;
+
+typedef struct {
+    HuffEntry litlen[LITLEN_TABLE_SIZE];
+    HuffEntry dist[DIST_TABLE_SIZE];
+    HuffEntry precode[PRECODE_TABLE_SIZE];
+} InflateTables;
+
+// LSB-first bit reader over the whole input with a 64-bit buffer
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    size_t pos;       // Next byte to load
+    uint64_t bits;
+    int count;        // Valid bits in the buffer
+} BitReader;
+
+// Top the buffer up to at least 56 bits. While 8 input bytes remain this
+// loads a whole word; the bits above count then already hold the next
+// input bytes, and later loads OR the same values over them. Past the
+// end, zero bytes are supplied and pos keeps counting so that overreads
+// can be detected.
+static inline void refill(BitReader *br) {
+    if (br->pos + 8 <= br->size) {
+        uint64_t word;
+        memcpy(&word, br->data + br->pos, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        br->bits |= word << br->count;
+        br->pos += (63 - br->count) >> 3;
+        br->count |= 56;
+    } else {
+        while (br->count <= 56) {
+            uint64_t byte = br->pos < br->size ? br->data[br->pos] : 0;
+            br->bits |= byte << br->count;
+            br->pos++;
+            br->count += 8;
+        }
+    }
+}
+
+static inline uint32_t take_bits(BitReader *br, int count) {
+    uint32_t value = (uint32_t)(br->bits & ((1ull << count) - 1));
+    br->bits >>= count;
+    br->count -= count;
+    return value;
+}
+
+// Whether more bits have been consumed than the input holds
+static inline int overread(const BitReader *br) {
+    return br->pos * 8 - br->count > br->size * 8;
+}
+
+static inline HuffEntry decode_symbol(BitReader *br, const HuffEntry *table, int table_bits) {
+    HuffEntry entry = table[br->bits & ((1u << table_bits) - 1)];
+    if (entry.sub_bits) {
+        br->bits >>= table_bits;
+        br->count -= table_bits;
+        entry = table[entry.symbol + (br->bits & ((1u << entry.sub_bits) - 1))];
+    }
+    br->bits >>= entry.length;
+    br->count -= entry.length;
+    return entry;
+}
+
+// Build the decoding table (of table_size entries) of the canonical code
+// with the given lengths (0 = unused). Returns 1 if the lengths are
+// oversubscribed (or the subtables would not fit); slots left by an
+// incomplete code decode to INVALID_SYMBOL.
+static int build_decode_table(HuffEntry *table, int table_size, const uint8_t *lengths,
+                              int num_symbols, int table_bits) {
+    int count[MAX_BITS + 1] = {0};
+    for (int i = 0; i < num_symbols; i++) {
+        count[lengths[i]]++;
+    }
+    count[0] = 0;
+
+    int left = 1;
+    int max_len = 0;
+    for (int len = 1; len <= MAX_BITS; len++) {
+        left = (left << 1) - count[len];
+        if (left < 0) return 1;
+        if (count[len]) max_len = len;
+    }
+
+    // Symbols in canonical order: by length, then by value
+    int offsets[MAX_BITS + 1];
+    offsets[1] = 0;
+    for (int len = 1; len < MAX_BITS; len++) {
+        offsets[len + 1] = offsets[len] + count[len];
+    }
+    uint16_t sorted[LITLEN_SYMBOLS];
+    int total = 0;
+    for (int i = 0; i < num_symbols; i++) {
+        if (lengths[i]) {
+            sorted[offsets[lengths[i]]++] = (uint16_t)i;
+            total++;
+        }
+    }
+
+    HuffEntry invalid = { INVALID_SYMBOL, 0, 0 };
+    int primary_size = 1 << table_bits;
+    int sub_bits = max_len - table_bits;  // Used only if positive
+    for (int i = 0; i < primary_size; i++) {
+        table[i] = invalid;
+    }
+
+    // Codes sharing their first table_bits bits are consecutive in
+    // canonical order, so each subtable is filled in one run
+    int next_free = primary_size;
+    int sub_start = 0;
+    int link_slot = -1;
+    uint32_t code = 0;
+    int prev_len = total ? lengths[sorted[0]] : 0;
+    for (int k = 0; k < total; k++) {
+        int symbol = sorted[k];
+        int len = lengths[symbol];
+        if (k > 0) {
+            code = (code + 1) << (len - prev_len);
+            prev_len = len;
+        }
+        uint32_t reversed = reverse_bits(code, len);
+
+        if (len <= table_bits) {
+            HuffEntry entry = { (uint16_t)symbol, (uint8_t)len, 0 };
+            for (uint32_t i = reversed; i < (uint32_t)primary_size; i += 1u << len) {
+                table[i] = entry;
+            }
+            continue;
+        }
+
+        int slot = reversed & (primary_size - 1);
+        if (slot != link_slot) {
+            link_slot = slot;
+            sub_start = next_free;
+            next_free += 1 << sub_bits;
+            if (next_free > table_size) return 1;
+            for (int i = 0; i < (1 << sub_bits); i++) {
+                table[sub_start + i] = invalid;
+            }
+            HuffEntry link = { (uint16_t)sub_start, (uint8_t)table_bits, (uint8_t)sub_bits };
+            table[slot] = link;
+        }
+        HuffEntry entry = { (uint16_t)symbol, (uint8_t)(len - table_bits), 0 };
+        for (uint32_t i = reversed >> table_bits; i < (1u << sub_bits); i += 1u << (len - table_bits)) {
+            table[sub_start + i] = entry;
+        }
+    }
+    return 0;
+}
+
+static void build_fixed_tables(InflateTables *tables) {
+    uint8_t lengths[LITLEN_SYMBOLS];
+    for (int i = 0; i < LITLEN_SYMBOLS; i++) {
+        lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    }
+    build_decode_table(tables->litlen, LITLEN_TABLE_SIZE, lengths, LITLEN_SYMBOLS, LITLEN_TABLE_BITS);
+
+    // 32 five-bit codes; 30 and 31 never occur in valid data
+    memset(lengths, 5, 32);
+    build_decode_table(tables->dist, DIST_TABLE_SIZE, lengths, 32, DIST_TABLE_BITS);
+}
+
+// Read the code length code and the literal/length and distance code
+// lengths of a dynamic block; returns an error message or NULL
+static const char* read_dynamic_tables(BitReader *br, InflateTables *tables) {
+    static const uint8_t precode_order[PRECODE_SYMBOLS] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    };
+
+    refill(br);
+    int hlit = take_bits(br, 5) + 257;
+    int hdist = take_bits(br, 5) + 1;
+    int hclen = take_bits(br, 4) + 4;
+    if (hlit > MAX_CODES || hdist > DIST_CODES) {
+        return "too many length or distance codes";
+    }
+
+    uint8_t precode_lengths[PRECODE_SYMBOLS] = {0};
+    for (int i = 0; i < hclen; i++) {
+        refill(br);
+        precode_lengths[precode_order[i]] = (uint8_t)take_bits(br, 3);
+    }
+    if (build_decode_table(tables->precode, PRECODE_TABLE_SIZE, precode_lengths, PRECODE_SYMBOLS, PRECODE_TABLE_BITS)) {
+        return "invalid code length code";
+    }
+
+    // Literal/length and distance lengths form one sequence, and runs may
+    // cross from one into the other
+    uint8_t lengths[MAX_CODES + DIST_CODES];
+    int n = 0;
+    while (n < hlit + hdist) {
+        refill(br);
+        HuffEntry entry = decode_symbol(br, tables->precode, PRECODE_TABLE_BITS);
+        if (entry.symbol < 16) {
+            lengths[n++] = (uint8_t)entry.symbol;
+            continue;
+        }
+
+        int value = 0;
+        int repeat;
+        if (entry.symbol == 16) {
+            if (n == 0) return "repeat with no previous length";
+            value = lengths[n - 1];
+            repeat = 3 + take_bits(br, 2);
+        } else if (entry.symbol == 17) {
+            repeat = 3 + take_bits(br, 3);
+        } else if (entry.symbol == 18) {
+            repeat = 11 + take_bits(br, 7);
+        } else {
+            return "invalid code length code";
+        }
+        if (n + repeat > hlit + hdist) return "code lengths overrun";
+        while (repeat-- > 0) {
+            lengths[n++] = (uint8_t)value;
+        }
+    }
+
+    if (overread(br)) return "truncated input";
+    if (lengths[256] == 0) return "missing end-of-block code";
+    if (build_decode_table(tables->litlen, LITLEN_TABLE_SIZE, lengths, hlit, LITLEN_TABLE_BITS)) {
+        return "invalid literal/length code";
+    }
+    if (build_decode_table(tables->dist, DIST_TABLE_SIZE, lengths + hlit, hdist, DIST_TABLE_BITS)) {
+        return "invalid distance code";
+    }
+    return NULL;
+}
+
+// Growable output; matches reference everything written so far
+typedef struct {
+    unsigned char *data;
+    size_t pos;
+    size_t capacity;
+} OutputBuffer;
+
+static inline void reserve_output(OutputBuffer *out, size_t extra) {
+    if (out->pos + extra > out->capacity) {
+        while (out->pos + extra > out->capacity) {
+            out->capacity *= 2;
+        }
+        out->data = (unsigned char*)realloc(out->data, out->capacity);
+    }
+}
+
+// Copy a match of length bytes from distance back. Distances of 8 or more
+// are copied a word at a time, which may write up to 7 bytes past the
+// match; callers reserve that slack.
+static inline void copy_match(unsigned char *dst, size_t distance, int length) {
+    const unsigned char *src = dst - distance;
+    if (distance >= 8) {
+        unsigned char *end = dst + length;
+        do {
+            uint64_t word;
+            memcpy(&word, src, sizeof(word));
+            memcpy(dst, &word, sizeof(word));
+            src += 8;
+            dst += 8;
+        } while (dst < end);
+    } else if (distance == 1) {
+        memset(dst, src[0], length);
+    } else {
+        for (int i = 0; i < length; i++) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+// Decode one Huffman-coded block; returns an error message or NULL
+static const char* inflate_block(BitReader *br, const InflateTables *tables, OutputBuffer *out) {
+    for (;;) {
+        reserve_output(out, MAX_MATCH + 8);
+        refill(br);
+        if (br->pos > br->size + 8) return "truncated input";
+
+        // Literals come in runs, and two codes (at most 30 bits) fit in
+        // one refill
+        HuffEntry entry = decode_symbol(br, tables->litlen, LITLEN_TABLE_BITS);
+        if (entry.symbol < LITERALS) {
+            out->data[out->pos++] = (unsigned char)entry.symbol;
+            entry = decode_symbol(br, tables->litlen, LITLEN_TABLE_BITS);
+            if (entry.symbol < LITERALS) {
+                out->data[out->pos++] = (unsigned char)entry.symbol;
+                continue;
+            }
+        }
+        if (entry.symbol == 256) return NULL;
+        if (entry.symbol >= MAX_CODES) return "invalid literal/length code";
+
+        int index = entry.symbol - 257;
+        int length = length_base[index] + take_bits(br, length_extra[index]);
+
+        // A distance code and its extra bits take at most 28 bits
+        if (br->count < 28) refill(br);
+        entry = decode_symbol(br, tables->dist, DIST_TABLE_BITS);
+        if (entry.symbol >= DIST_CODES) return "invalid distance code";
+        size_t distance = dist_base[entry.symbol] + take_bits(br, dist_extra[entry.symbol]);
+        if (distance > out->pos) return "distance too far back";
+
+        copy_match(out->data + out->pos, distance, length);
+        out->pos += length;
+    }
+}
+
+// Decompress a raw DEFLATE stream (RFC 1951) held in memory. On success
+// *output is a malloc'ed buffer of *output_size bytes.
+int inflate_buffer(const unsigned char *input, size_t input_size,
+                   unsigned char **output, size_t *output_size) {
+    BitReader br = { input, input_size, 0, 0, 0 };
+    OutputBuffer out;
+    out.capacity = input_size * 4 > 65536 ? input_size * 4 : 65536;
+    out.data = (unsigned char*)malloc(out.capacity);
+    out.pos = 0;
+    InflateTables *tables = (InflateTables*)malloc(sizeof(InflateTables));
+
+    const char *error = NULL;
+    int final = 0;
+    while (!final && error == NULL) {
+        refill(&br);
+        final = take_bits(&br, 1);
+        int type = take_bits(&br, 2);
+
+        if (type == 0) {
+            // Stored block: skip to a byte boundary; LEN, its complement,
+            // then LEN raw bytes
+            take_bits(&br, br.count & 7);
+            uint32_t len = take_bits(&br, 16);
+            uint32_t nlen = take_bits(&br, 16);
+            if (len != (~nlen & 0xFFFF)) {
+                error = "stored block length mismatch";
+                break;
+            }
+            // Hand the whole bytes still buffered back to the input
+            size_t start = br.pos - br.count / 8;
+            br.bits = 0;
+            br.count = 0;
+            if (start > input_size || len > input_size - start) {
+                error = "truncated input";
+                break;
+            }
+            reserve_output(&out, len + 8);
+            memcpy(out.data + out.pos, input + start, len);
+            out.pos += len;
+            br.pos = start + len;
+        } else if (type == 1) {
+            build_fixed_tables(tables);
+            error = inflate_block(&br, tables, &out);
+        } else if (type == 2) {
+            error = read_dynamic_tables(&br, tables);
+            if (error == NULL) {
+                error = inflate_block(&br, tables, &out);
+            }
+        } else {
+            error = "invalid block type";
+        }
+    }
+    if (error == NULL && overread(&br)) {
+        error = "truncated input";
+    }
+
+    free(tables);
+    if (error) {
+        fprintf(stderr, "Error: Invalid DEFLATE data: %s\n", error);
+        free(out.data);
+        return 1;
+    }
+    *output = out.data;
+    *output_size = out.pos;
+    return 0;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// DEFLATE decompression of a raw stream file
+int deflate_decompress(const char *input_filename, const char *output_filename) {
+    // Read input file
+    FILE *input = fopen(input_filename, "rb");
+    if (!input) {
+        fprintf(stderr, "Error: Cannot open input file '%s'\n", input_filename);
+        return 1;
+    }
+
+    fseek(input, 0, SEEK_END);
+    size_t input_size = ftell(input);
+    fseek(input, 0, SEEK_SET);
+
+    unsigned char *input_data = (unsigned char*)malloc(input_size > 0 ? input_size : 1);
+    size_t bytes_read = fread(input_data, 1, input_size, input);
+    fclose(input);
+    if (bytes_read != input_size) {
+        fprintf(stderr, "Error: Failed to read input file\n");
+        free(input_data);
+        return 1;
+    }
+
+    unsigned char *output_data = NULL;
+    size_t output_size = 0;
+    double start = now_seconds();
+    int status = inflate_buffer(input_data, input_size, &output_data, &output_size);
+    double seconds = now_seconds() - start;
+    free(input_data);
+    if (status != 0) {
+        return 1;
+    }
+
+    // Write output file
+    FILE *output = fopen(output_filename, "wb");
+    if (!output) {
+        fprintf(stderr, "Error: Cannot open output file '%s'\n", output_filename);
+        free(output_data);
+        return 1;
+    }
+    fwrite(output_data, 1, output_size, output);
+    fclose(output);
+
+    // Print statistics
+    printf("Decompression complete!\n");
+    printf("Input size:  %zu bytes\n", input_size);
+    printf("Output size: %zu bytes\n", output_size);
+    if (seconds > 0) {
+        printf("Throughput:  %.1f MB/s\n", output_size / seconds / 1e6);
+    }
+
+    free(output_data);
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
+    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+        printf("Decompressing '%s' to '%s' using DEFLATE...\n", argv[2], argv[3]);
+        return deflate_decompress(argv[2], argv[3]);
+    }
+
     if (argc != 3) {
-        printf("Usage: %s <input_file> <output_file>\n", argv[0]);
+        printf("Usage: %s [-d] <input_file> <output_file>\n", argv[0]);
         printf("Compresses input_file using DEFLATE algorithm and writes to output_file\n");
+        printf("  -d  Decompress a raw DEFLATE stream instead\n");
         return 1;
     }
 
@@ -2,149 +2,168 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
-
-#define MAX_DICT_SIZE 4096  // 12-bit codes
+#include <time.h>
+
+// Output format is that of Unix compress (.Z): a 3-byte header, then codes
+// packed LSB first that start at 9 bits and widen by one bit each time the
+// dictionary outgrows them, up to max_bits. Code 256 (CLEAR) resets the
+// dictionary.
+#define MAGIC_1 0x1F
+#define MAGIC_2 0x9D
+#define BLOCK_MODE 0x80  // Header flag: CLEAR code in use
+#define BITS_MASK 0x1F   // Header: max_bits in the low bits
+
+#define INIT_BITS 9
+#define MAX_BITS 16
+#define MAX_DICT_SIZE (1 << MAX_BITS)
 #define INIT_DICT_SIZE 256  // ASCII characters
-#define HASH_TABLE_SIZE 8192  // Power of 2 for fast modulo
-#define MAX_STRING_LEN 256
+#define CLEAR_CODE 256
+#define FIRST_CODE 257      // First string code in block mode
+#define CHECK_GAP 10000     // Input bytes between ratio checks once full
+#define HASH_TABLE_BITS 17
+#define HASH_TABLE_SIZE (1 << HASH_TABLE_BITS)  // Twice the codes, so probes stay short
 #define BUFFER_SIZE 65536  // 64KB buffer for I/O
 
-// Hash table entry for fast lookups
-typedef struct HashEntry {
-    unsigned char *string;
-    int length;
-    int code;
-    struct HashEntry *next;  // For collision chaining
+// Every string past the single bytes is a shorter string's code plus one
+// byte, so the dictionary only maps (prefix code, next byte) to a code
+typedef struct {
+    int32_t key;    // (prefix << 8) | byte, or -1 if the slot is empty
+    uint16_t code;
 } HashEntry;
 
-// Dictionary structure with hash table
+// Dictionary structure: open-addressed hash table with linear probing;
+// codes below INIT_DICT_SIZE are the bytes themselves and not stored
 typedef struct {
-    unsigned char *string_pool;  // Pre-allocated memory pool
-    int pool_offset;
     int size;
-    int capacity;
-    HashEntry **hash_table;
-    HashEntry *entries;  // Pre-allocated entries
+    HashEntry *hash_table;
 } Dictionary;
 
-// Fast hash function (FNV-1a)
-static inline uint32_t hash_string(const unsigned char *str, int len) {
-    uint32_t hash = 2166136261u;
-    for (int i = 0; i < len; i++) {
-        hash ^= str[i];
-        hash *= 16777619u;
-    }
-    return hash;
+// Multiplicative (Fibonacci) hash of a prefix/byte key
+static inline uint32_t hash_key(uint32_t key) {
+    return (key * 2654435761u) >> (32 - HASH_TABLE_BITS);
+}
+
+// Drop every string code; all-ones bytes mark every slot empty
+static void reset_dictionary(Dictionary *dict) {
+    dict->size = FIRST_CODE;
+    memset(dict->hash_table, 0xFF, HASH_TABLE_SIZE * sizeof(HashEntry));
 }
 
 // Initialize dictionary with hash table
 Dictionary* init_dictionary() {
     Dictionary *dict = (Dictionary*)malloc(sizeof(Dictionary));
-    dict->capacity = MAX_DICT_SIZE;
-    dict->size = INIT_DICT_SIZE;
-    dict->pool_offset = 0;
-
-    // Pre-allocate string pool
-    dict->string_pool = (unsigned char*)malloc(MAX_DICT_SIZE * MAX_STRING_LEN);
-
-    // Pre-allocate entries
-    dict->entries = (HashEntry*)calloc(MAX_DICT_SIZE, sizeof(HashEntry));
-
-    // Initialize hash table
-    dict->hash_table = (HashEntry**)calloc(HASH_TABLE_SIZE, sizeof(HashEntry*));
-
-    // Initialize with all single-byte values
-    for (int i = 0; i < INIT_DICT_SIZE; i++) {
-        dict->entries[i].string = &dict->string_pool[dict->pool_offset];
-        dict->entries[i].string[0] = (unsigned char)i;
-        dict->entries[i].length = 1;
-        dict->entries[i].code = i;
-        dict->entries[i].next = NULL;
-        dict->pool_offset += 1;
-
-        // Add to hash table
-        uint32_t hash = hash_string(dict->entries[i].string, 1);
-        int idx = hash & (HASH_TABLE_SIZE - 1);
-        dict->entries[i].next = dict->hash_table[idx];
-        dict->hash_table[idx] = &dict->entries[i];
-    }
-
+    dict->hash_table = (HashEntry*)malloc(HASH_TABLE_SIZE * sizeof(HashEntry));
+    reset_dictionary(dict);
     return dict;
 }
 
-// Fast dictionary search using hash table
-static inline int search_dictionary(Dictionary *dict, const unsigned char *str, int len) {
-    uint32_t hash = hash_string(str, len);
-    int idx = hash & (HASH_TABLE_SIZE - 1);
+// Look up prefix + c; returns its code, or -1 with *slot set to the empty
+// slot where it would be added
+static inline int search_dictionary(const Dictionary *dict, int prefix, unsigned char c, int *slot) {
+    int32_t key = (prefix << 8) | c;
+    uint32_t idx = hash_key((uint32_t)key);
 
-    HashEntry *entry = dict->hash_table[idx];
-    while (entry) {
-        if (entry->length == len && memcmp(entry->string, str, len) == 0) {
-            return entry->code;
+    while (dict->hash_table[idx].key != -1) {
+        if (dict->hash_table[idx].key == key) {
+            return dict->hash_table[idx].code;
         }
-        entry = entry->next;
+        idx = (idx + 1) & (HASH_TABLE_SIZE - 1);
     }
+    *slot = (int)idx;
     return -1;
 }
 
-// Add a new entry to the dictionary with hash table
-static inline int add_to_dictionary(Dictionary *dict, const unsigned char *str, int len) {
-    if (dict->size >= dict->capacity || dict->pool_offset + len > MAX_DICT_SIZE * MAX_STRING_LEN) {
-        return -1;  // Dictionary full
-    }
-
-    int code = dict->size;
-    HashEntry *new_entry = &dict->entries[code];
-
-    // Use pre-allocated pool
-    new_entry->string = &dict->string_pool[dict->pool_offset];
-    memcpy(new_entry->string, str, len);
-    new_entry->length = len;
-    new_entry->code = code;
-    dict->pool_offset += len;
-
-    // Add to hash table
-    uint32_t hash = hash_string(str, len);
-    int idx = hash & (HASH_TABLE_SIZE - 1);
-    new_entry->next = dict->hash_table[idx];
-    dict->hash_table[idx] = new_entry;
-
-    dict->size++;
+// Add prefix + c at the slot found by search_dictionary
+static inline int add_to_dictionary(Dictionary *dict, int slot, int prefix, unsigned char c) {
+    int code = dict->size++;
+    dict->hash_table[slot].key = (prefix << 8) | c;
+    dict->hash_table[slot].code = (uint16_t)code;
     return code;
 }
 
 // Free dictionary memory
 void free_dictionary(Dictionary *dict) {
-    free(dict->string_pool);
-    free(dict->entries);
     free(dict->hash_table);
     free(dict);
 }
 
-// Write a 12-bit code to output file (with buffering)
-static inline void write_code(unsigned char **output_buffer, int *buf_pos,
-                              int code, int *bit_buffer, int *bits_in_buffer) {
-    *bit_buffer = (*bit_buffer << 12) | (code & 0xFFF);
-    *bits_in_buffer += 12;
+// Whether the code after this one is one bit wider, given the dictionary
+// size before the entry for this code is added. As in compress, a 9-bit
+// table still widens to 10 bits when it fills.
+static inline int widens(int size, int width, int max_bits) {
+    return size >= (1 << width) && (width < max_bits || width == INIT_BITS);
+}
+
+// Buffered LSB-first code output
+typedef struct {
+    FILE *file;
+    unsigned char *buffer;
+    int pos;
+    uint64_t bit_buffer;
+    int bits_in_buffer;
+    int width;                     // Current code width in bits
+    int codes;                     // Codes written at this width
+    unsigned long long bytes_out;  // Bytes already written to the file
+} CodeWriter;
+
+static inline void put_bits(CodeWriter *w, uint32_t value, int count) {
+    w->bit_buffer |= (uint64_t)value << w->bits_in_buffer;
+    w->bits_in_buffer += count;
 
     // Write complete bytes to buffer
-    while (*bits_in_buffer >= 8) {
-        *bits_in_buffer -= 8;
-        (*output_buffer)[(*buf_pos)++] = (*bit_buffer >> *bits_in_buffer) & 0xFF;
+    while (w->bits_in_buffer >= 8) {
+        w->buffer[w->pos++] = w->bit_buffer & 0xFF;
+        w->bit_buffer >>= 8;
+        w->bits_in_buffer -= 8;
     }
+
+    // Flush output buffer if needed
+    if (w->pos >= BUFFER_SIZE - 16) {
+        fwrite(w->buffer, 1, w->pos, w->file);
+        w->bytes_out += w->pos;
+        w->pos = 0;
+    }
+}
+
+static inline void write_code(CodeWriter *w, int code) {
+    put_bits(w, (uint32_t)code, w->width);
+    w->codes++;
 }
 
-// Flush remaining bits
-static inline void flush_bits(unsigned char *output_buffer, int *buf_pos,
-                              int *bit_buffer, int *bits_in_buffer) {
-    if (*bits_in_buffer > 0) {
-        *bit_buffer <<= (8 - *bits_in_buffer);
-        output_buffer[(*buf_pos)++] = *bit_buffer & 0xFF;
+// compress reads codes in groups of eight (width bytes), so a change of
+// width, or a CLEAR, pads out the current group
+static void end_group(CodeWriter *w) {
+    int pad = (8 - w->codes % 8) % 8 * w->width;
+    while (pad > 0) {
+        int count = pad < 16 ? pad : 16;
+        put_bits(w, 0, count);
+        pad -= count;
     }
+    w->codes = 0;
 }
 
-// LZW compression function with buffered I/O
-int lzw_compress(const char *input_filename, const char *output_filename) {
+// Flush remaining bits and buffered output
+static void flush_bits(CodeWriter *w) {
+    if (w->bits_in_buffer > 0) {
+        w->buffer[w->pos++] = w->bit_buffer & 0xFF;
+        w->bit_buffer = 0;
+        w->bits_in_buffer = 0;
+    }
+    if (w->pos > 0) {
+        fwrite(w->buffer, 1, w->pos, w->file);
+        w->bytes_out += w->pos;
+        w->pos = 0;
+    }
+}
+
+// LZW compression function with buffered I/O; max_bits (9-16) caps the
+// code width and so the dictionary size
+int lzw_compress(const char *input_filename, const char *output_filename, int max_bits) {
+    if (max_bits < INIT_BITS || max_bits > MAX_BITS) {
+        fprintf(stderr, "Error: Code width must be %d-%d bits, got %d\n", INIT_BITS, MAX_BITS, max_bits);
+        return 1;
+    }
+
     FILE *input = fopen(input_filename, "rb");
     if (!input) {
         fprintf(stderr, "Error: Cannot open input file '%s'\n", input_filename);
@@ -160,101 +179,359 @@ int lzw_compress(const char *input_filename, const char *output_filename) {
 
     // Allocate buffers
     unsigned char *input_buffer = (unsigned char*)malloc(BUFFER_SIZE);
-    unsigned char *output_buffer = (unsigned char*)malloc(BUFFER_SIZE);
-    unsigned char string_buffer[MAX_STRING_LEN];
+    CodeWriter writer = { output, (unsigned char*)malloc(BUFFER_SIZE), 0, 0, 0, INIT_BITS, 0, 0 };
+    writer.buffer[writer.pos++] = MAGIC_1;
+    writer.buffer[writer.pos++] = MAGIC_2;
+    writer.buffer[writer.pos++] = (unsigned char)(max_bits | BLOCK_MODE);
 
     Dictionary *dict = init_dictionary();
-    int string_len = 0;
-    int bit_buffer = 0;
-    int bits_in_buffer = 0;
-    int output_pos = 0;
+    int max_code = 1 << max_bits;
+    int prefix = -1;  // Code of the string matched so far, -1 before the first byte
+
+    // Once the dictionary is full it is kept while the overall ratio
+    // (input bytes per output byte) keeps improving, checked every
+    // CHECK_GAP bytes, and cleared as soon as it falls
+    unsigned long long in_count = 0;
+    unsigned long long checkpoint = CHECK_GAP;
+    double ratio = 0.0;
 
     // Read input in chunks
     size_t bytes_read;
-    int first_byte = 1;
 
     while ((bytes_read = fread(input_buffer, 1, BUFFER_SIZE, input)) > 0) {
         for (size_t i = 0; i < bytes_read; i++) {
             unsigned char c = input_buffer[i];
 
-            if (first_byte) {
-                string_buffer[string_len++] = c;
-                first_byte = 0;
+            if (prefix == -1) {
+                prefix = c;
                 continue;
             }
 
-            string_buffer[string_len] = c;
-
             // Check if current string + new byte exists in dictionary
-            int code = search_dictionary(dict, string_buffer, string_len + 1);
+            int slot;
+            int code = search_dictionary(dict, prefix, c, &slot);
 
             if (code != -1) {
-                // String exists, extend buffer
-                string_len++;
-            } else {
-                // String doesn't exist - output code for current string
-                int output_code = search_dictionary(dict, string_buffer, string_len);
-                if (output_code != -1) {
-                    write_code(&output_buffer, &output_pos, output_code,
-                              &bit_buffer, &bits_in_buffer);
-
-                    // Flush output buffer if needed
-                    if (output_pos >= BUFFER_SIZE - 16) {
-                        fwrite(output_buffer, 1, output_pos, output);
-                        output_pos = 0;
-                    }
-                }
+                // String exists, extend it
+                prefix = code;
+                continue;
+            }
 
-                // Add new string to dictionary
-                string_buffer[string_len] = c;
-                add_to_dictionary(dict, string_buffer, string_len + 1);
+            // String doesn't exist - output code for current string
+            write_code(&writer, prefix);
+
+            // Widen before the next code once it may need the extra bit
+            if (widens(dict->size, writer.width, max_bits)) {
+                end_group(&writer);
+                writer.width++;
+            }
 
-                // Reset string to the new character
-                string_buffer[0] = c;
-                string_len = 1;
+            if (dict->size < max_code) {
+                // Add new string to dictionary
+                add_to_dictionary(dict, slot, prefix, c);
+            } else if (in_count + i + 1 >= checkpoint) {
+                unsigned long long consumed = in_count + i + 1;
+                checkpoint = consumed + CHECK_GAP;
+                double current = (double)consumed / (writer.bytes_out + writer.pos);
+                if (current > ratio) {
+                    ratio = current;
+                } else {
+                    // Input has drifted away from the dictionary; start over
+                    write_code(&writer, CLEAR_CODE);
+                    end_group(&writer);
+                    writer.width = INIT_BITS;
+                    reset_dictionary(dict);
+                    ratio = 0.0;
+                }
             }
+
+            // Reset string to the new character
+            prefix = c;
         }
+        in_count += bytes_read;
     }
 
     // Output code for remaining string
-    if (string_len > 0) {
-        int output_code = search_dictionary(dict, string_buffer, string_len);
-        if (output_code != -1) {
-            write_code(&output_buffer, &output_pos, output_code,
-                      &bit_buffer, &bits_in_buffer);
+    if (prefix != -1) {
+        write_code(&writer, prefix);
+    }
+
+    flush_bits(&writer);
+
+    free(input_buffer);
+    free(writer.buffer);
+    fclose(input);
+    fclose(output);
+    free_dictionary(dict);
+
+    return 0;
+}
+
+// Buffered LSB-first code input
+typedef struct {
+    FILE *file;
+    unsigned char *buffer;
+    size_t pos;
+    size_t len;
+    uint64_t bit_buffer;
+    int bits_in_buffer;
+} CodeReader;
+
+// Next count (at most 16) bits, or -1 at the end of the input
+static inline int read_bits(CodeReader *r, int count) {
+    if (r->bits_in_buffer < count) {
+        while (r->bits_in_buffer <= 56) {
+            if (r->pos == r->len) {
+                r->len = fread(r->buffer, 1, BUFFER_SIZE, r->file);
+                r->pos = 0;
+                if (r->len == 0) break;
+            }
+            r->bit_buffer |= (uint64_t)r->buffer[r->pos++] << r->bits_in_buffer;
+            r->bits_in_buffer += 8;
         }
+        if (r->bits_in_buffer < count) return -1;
     }
 
-    // Flush remaining bits
-    flush_bits(output_buffer, &output_pos, &bit_buffer, &bits_in_buffer);
+    int value = (int)(r->bit_buffer & ((1u << count) - 1));
+    r->bit_buffer >>= count;
+    r->bits_in_buffer -= count;
+    return value;
+}
 
-    // Write remaining output
-    if (output_pos > 0) {
+// Skip the padding after the last code of a group (see end_group)
+static void skip_group(CodeReader *r, int codes, int width) {
+    int pad = (8 - codes % 8) % 8 * width;
+    while (pad > 0) {
+        int count = pad < 16 ? pad : 16;
+        if (read_bits(r, count) < 0) return;
+        pad -= count;
+    }
+}
+
+// Decoder table: each code is its prefix code plus one byte, so no
+// strings are stored; lengths let a string be written back to front
+// straight into the output buffer
+typedef struct {
+    uint16_t prefix[MAX_DICT_SIZE];
+    unsigned char suffix[MAX_DICT_SIZE];
+    unsigned char first[MAX_DICT_SIZE];  // First byte of the string
+    uint16_t length[MAX_DICT_SIZE];
+    int size;
+} DecodeTable;
+
+static void init_decode_table(DecodeTable *table) {
+    for (int i = 0; i < INIT_DICT_SIZE; i++) {
+        table->prefix[i] = 0;
+        table->suffix[i] = (unsigned char)i;
+        table->first[i] = (unsigned char)i;
+        table->length[i] = 1;
+    }
+}
+
+// Write the string for code at out; returns its length
+static inline int write_string(const DecodeTable *table, int code, unsigned char *out) {
+    int length = table->length[code];
+    unsigned char *p = out + length;
+    while (code >= INIT_DICT_SIZE) {
+        *--p = table->suffix[code];
+        code = table->prefix[code];
+    }
+    *--p = (unsigned char)code;
+    return length;
+}
+
+// LZW decompression of .Z streams (from lzw_compress or compress);
+// streams through fixed-size buffers
+int lzw_decompress(const char *input_filename, const char *output_filename) {
+    FILE *input = fopen(input_filename, "rb");
+    if (!input) {
+        fprintf(stderr, "Error: Cannot open input file '%s'\n", input_filename);
+        return 1;
+    }
+
+    unsigned char header[3];
+    if (fread(header, 1, 3, input) != 3 || header[0] != MAGIC_1 || header[1] != MAGIC_2) {
+        fprintf(stderr, "Error: '%s' is not in compress (.Z) format\n", input_filename);
+        fclose(input);
+        return 1;
+    }
+    int max_bits = header[2] & BITS_MASK;
+    int block_mode = (header[2] & BLOCK_MODE) != 0;
+    if (max_bits < INIT_BITS || max_bits > MAX_BITS) {
+        fprintf(stderr, "Error: '%s' uses %d-bit codes (supported: %d-%d)\n",
+                input_filename, max_bits, INIT_BITS, MAX_BITS);
+        fclose(input);
+        return 1;
+    }
+
+    FILE *output = fopen(output_filename, "wb");
+    if (!output) {
+        fprintf(stderr, "Error: Cannot open output file '%s'\n", output_filename);
+        fclose(input);
+        return 1;
+    }
+
+    // The output buffer has room for one more string of maximum length
+    // past the flush threshold
+    CodeReader reader = { input, (unsigned char*)malloc(BUFFER_SIZE), 0, 0, 0, 0 };
+    unsigned char *output_buffer = (unsigned char*)malloc(BUFFER_SIZE + MAX_DICT_SIZE);
+    DecodeTable *table = (DecodeTable*)malloc(sizeof(DecodeTable));
+    init_decode_table(table);
+
+    int first_code = block_mode ? FIRST_CODE : INIT_DICT_SIZE;
+    int max_code = 1 << max_bits;
+    int width = INIT_BITS;
+    int codes = 0;  // Codes read at this width
+    int output_pos = 0;
+    int prev = -1;
+    int status = 0;
+    table->size = first_code;
+
+    for (;;) {
+        if (widens(table->size, width, max_bits)) {
+            skip_group(&reader, codes, width);
+            width++;
+            codes = 0;
+        }
+
+        int code = read_bits(&reader, width);
+        if (code < 0) break;
+        codes++;
+
+        if (code == CLEAR_CODE && block_mode) {
+            skip_group(&reader, codes, width);
+            width = INIT_BITS;
+            codes = 0;
+            table->size = first_code;
+            prev = -1;
+            continue;
+        }
+
+        if (prev == -1) {
+            if (code >= INIT_DICT_SIZE) {
+                status = 1;
+                break;
+            }
+            output_buffer[output_pos++] = (unsigned char)code;
+            prev = code;
+            continue;
+        }
+
+        unsigned char first;
+        if (code < table->size) {
+            output_pos += write_string(table, code, output_buffer + output_pos);
+            first = table->first[code];
+        } else if (code == table->size && table->size < max_code) {
+            // The code being defined: previous string plus its own first byte
+            output_pos += write_string(table, prev, output_buffer + output_pos);
+            first = table->first[prev];
+            output_buffer[output_pos++] = first;
+        } else {
+            status = 1;
+            break;
+        }
+
+        // The entry the encoder added after emitting prev
+        if (table->size < max_code) {
+            int entry = table->size++;
+            table->prefix[entry] = (uint16_t)prev;
+            table->suffix[entry] = first;
+            table->first[entry] = table->first[prev];
+            table->length[entry] = table->length[prev] + 1;
+        }
+        prev = code;
+
+        if (output_pos >= BUFFER_SIZE) {
+            fwrite(output_buffer, 1, output_pos, output);
+            output_pos = 0;
+        }
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "Error: Corrupt LZW stream in '%s'\n", input_filename);
+    } else if (output_pos > 0) {
         fwrite(output_buffer, 1, output_pos, output);
     }
 
-    free(input_buffer);
+    free(reader.buffer);
     free(output_buffer);
+    free(table);
     fclose(input);
     fclose(output);
-    free_dictionary(dict);
 
-    return 0;
+    return status;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long file_size(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s [-d] [-b bits] <input_file> <output_file>\n", program);
+    printf("Compresses input_file using LZW algorithm and writes to output_file\n");
+    printf("in Unix compress (.Z) format\n");
+    printf("  -d       Decompress input_file instead\n");
+    printf("  -b bits  Maximum code width, %d-%d (default %d)\n", INIT_BITS, MAX_BITS, MAX_BITS);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        printf("Usage: %s <input_file> <output_file>\n", argv[0]);
-        printf("Compresses input_file using LZW algorithm and writes to output_file\n");
+    int decompress = 0;
+    int max_bits = MAX_BITS;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-d") == 0) {
+            decompress = 1;
+        } else if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc) {
+            max_bits = atoi(argv[++arg]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - arg != 2) {
+        usage(argv[0]);
         return 1;
     }
 
-    const char *input_file = argv[1];
-    const char *output_file = argv[2];
+    const char *input_file = argv[arg];
+    const char *output_file = argv[arg + 1];
+
+    if (decompress) {
+        printf("Decompressing '%s' to '%s'...\n", input_file, output_file);
+        double start = now_seconds();
+        if (lzw_decompress(input_file, output_file) != 0) {
+            fprintf(stderr, "Decompression failed!\n");
+            return 1;
+        }
+        double seconds = now_seconds() - start;
+
+        long output_size = file_size(output_file);
+        printf("Decompression complete!\n");
+        printf("Input size:  %ld bytes\n", file_size(input_file));
+        printf("Output size: %ld bytes\n", output_size);
+        if (seconds > 0) {
+            printf("Throughput:  %.1f MB/s\n", output_size / seconds / 1e6);
+        }
+        return 0;
+    }
 
     printf("Compressing '%s' to '%s'...\n", input_file, output_file);
 
-    if (lzw_compress(input_file, output_file) == 0) {
+    double start = now_seconds();
+    if (lzw_compress(input_file, output_file, max_bits) == 0) {
+        double seconds = now_seconds() - start;
+
         // Get file sizes
         FILE *in = fopen(input_file, "rb");
         FILE *out = fopen(output_file, "rb");
@@ -275,6 +552,9 @@ int main(int argc, char *argv[]) {
                 double ratio = (double)output_size / input_size * 100.0;
                 printf("Compression ratio: %.2f%%\n", ratio);
             }
+            if (seconds > 0) {
+                printf("Throughput:  %.1f MB/s\n", input_size / seconds / 1e6);
+            }
         }
 
         return 0;
@@ -22,8 +22,8 @@ SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 DEFLATE_BINARY="$SCRIPT_DIR/deflate"
 TEST_DIR="/tmp/deflate_tests_$$"
 
-# Compile the DEFLATE program if needed
-if [ ! -f "$DEFLATE_BINARY" ]; then
+# Compile the DEFLATE program if needed (or if the source is newer)
+if [ ! -f "$DEFLATE_BINARY" ] || [ "$SCRIPT_DIR/deflate.c" -nt "$DEFLATE_BINARY" ]; then
     echo -e "${YELLOW}Compiling DEFLATE compression program with optimizations...${NC}"
     gcc -o "$DEFLATE_BINARY" "$SCRIPT_DIR/deflate.c" -Wall -O3 -march=native
     echo -e "${GREEN}Compilation successful!${NC}\n"
@@ -106,6 +106,38 @@ run_compression_test() {
     fi
 }
 
+# Function to decompress a raw DEFLATE stream with -d and compare
+run_decompression_test() {
+    local test_name="$1"
+    local compressed_file="$2"
+    local expected_file="$3"
+
+    local restored_file="$TEST_DIR/restored.out"
+
+    if ! "$DEFLATE_BINARY" -d "$compressed_file" "$restored_file" > "$TEST_DIR/deflate_output.txt" 2>&1; then
+        test_result "$test_name" "FAIL" "Decompression command failed: $(grep Error "$TEST_DIR/deflate_output.txt")"
+        return 1
+    fi
+
+    local expected_size=$(stat -f%z "$expected_file" 2>/dev/null || stat -c%s "$expected_file" 2>/dev/null)
+    if cmp -s "$expected_file" "$restored_file"; then
+        test_result "$test_name" "PASS" "Restored ${expected_size}B exactly"
+    else
+        test_result "$test_name" "FAIL" "Decompressed output differs from the ${expected_size}B original"
+    fi
+}
+
+# Write the raw DEFLATE stream (no zlib header) of a file as zlib makes it
+zlib_deflate() {
+    python3 -c "
+import sys, zlib
+level, strategy = int(sys.argv[3]), int(sys.argv[4])
+c = zlib.compressobj(level, zlib.DEFLATED, -15, 9, strategy)
+data = open(sys.argv[1], 'rb').read()
+open(sys.argv[2], 'wb').write(c.compress(data) + c.flush())
+" "$@"
+}
+
 echo -e "${BLUE}================================${NC}"
 echo -e "${BLUE}DEFLATE COMPRESSION TEST SUITE${NC}"
 echo -e "${BLUE}================================${NC}\n"
@@ -209,6 +241,72 @@ if [ -f "$SCRIPT_DIR/deflate.c" ]; then
     run_compression_test "DEFLATE source code" "$SCRIPT_DIR/deflate.c" "should_compress"
 fi
 
+# TEST 16: Round trip of every file above through deflate -d
+echo -e "${YELLOW}Test 16: Round trips through the decompressor${NC}"
+for file in empty single repetitive classic random words numbers ascii_repeated json_like \
+            mixed_repeated binary xml_like special long_pattern; do
+    "$DEFLATE_BINARY" "$TEST_DIR/$file.txt" "$TEST_DIR/$file.deflate" > /dev/null
+    run_decompression_test "Round trip: $file" "$TEST_DIR/$file.deflate" "$TEST_DIR/$file.txt"
+done
+
+# TEST 17: The output is standard DEFLATE; zlib can read it
+echo -e "${YELLOW}Test 17: zlib reads our output${NC}"
+"$DEFLATE_BINARY" "$SCRIPT_DIR/deflate.c" "$TEST_DIR/source.deflate" > /dev/null
+if python3 -c "
+import sys, zlib
+data = zlib.decompress(open(sys.argv[1], 'rb').read(), -15)
+sys.exit(data != open(sys.argv[2], 'rb').read())
+" "$TEST_DIR/source.deflate" "$SCRIPT_DIR/deflate.c" 2>/dev/null; then
+    test_result "zlib decompresses our output" "PASS" ""
+else
+    test_result "zlib decompresses our output" "FAIL" "zlib rejected the stream or its output differs"
+fi
+
+# TEST 18: zlib streams of every block type (level 0 stores, Z_FIXED = 4
+# forces fixed codes, the rest use dynamic codes)
+echo -e "${YELLOW}Test 18: zlib output (stored, fixed and dynamic blocks)${NC}"
+python3 << PYTHON_EOF > "$TEST_DIR/corpus.bin"
+import random, sys
+random.seed(3)
+words = open("$SCRIPT_DIR/deflate.c").read().split()
+text = " ".join(random.choice(words) for _ in range(150000)).encode()
+noise = bytes(random.getrandbits(8) for _ in range(100000))
+sys.stdout.buffer.write(text + noise + b"z" * 50000 + text[:100000])
+PYTHON_EOF
+for setting in "0 0 stored" "6 4 fixed" "1 0 dynamic, level 1" "9 0 dynamic, level 9" "6 2 Huffman only" "6 3 RLE"; do
+    set -- $setting
+    level=$1
+    strategy=$2
+    shift 2
+    zlib_deflate "$TEST_DIR/corpus.bin" "$TEST_DIR/zlib.deflate" $level $strategy
+    run_decompression_test "zlib stream: $*" "$TEST_DIR/zlib.deflate" "$TEST_DIR/corpus.bin"
+done
+
+# TEST 19: Corrupt and truncated streams are rejected
+echo -e "${YELLOW}Test 19: Corrupt streams${NC}"
+printf '\x07' > "$TEST_DIR/bad_type.deflate"
+head -c 1000 "$TEST_DIR/zlib.deflate" > "$TEST_DIR/truncated.deflate"
+printf '\x01\x05\x00\x00\x00abcde' > "$TEST_DIR/bad_stored.deflate"
+for file in bad_type truncated bad_stored; do
+    if "$DEFLATE_BINARY" -d "$TEST_DIR/$file.deflate" "$TEST_DIR/$file.out" > "$TEST_DIR/deflate_output.txt" 2>&1; then
+        test_result "Corrupt stream: $file" "FAIL" "Decompression succeeded"
+    else
+        test_result "Corrupt stream: $file" "PASS" "$(grep Error "$TEST_DIR/deflate_output.txt")"
+    fi
+done
+
+# TEST 20: Decompression throughput on zlib's default output
+echo -e "${YELLOW}Test 20: Throughput${NC}"
+for i in 1 2 3 4 5 6 7 8; do cat "$TEST_DIR/corpus.bin"; done > "$TEST_DIR/large.bin"
+zlib_deflate "$TEST_DIR/large.bin" "$TEST_DIR/large.deflate" 6 0
+speed=$("$DEFLATE_BINARY" -d "$TEST_DIR/large.deflate" "$TEST_DIR/large.out" | awk '/Throughput/ {print $2}')
+large_size=$(stat -f%z "$TEST_DIR/large.bin" 2>/dev/null || stat -c%s "$TEST_DIR/large.bin" 2>/dev/null)
+if cmp -s "$TEST_DIR/large.bin" "$TEST_DIR/large.out"; then
+    test_result "Throughput (${large_size}B)" "PASS" "Decompress: ${speed} MB/s"
+else
+    test_result "Throughput (${large_size}B)" "FAIL" "Decompressed output differs"
+fi
+
 # Print summary
 echo -e "${BLUE}================================${NC}"
 echo -e "${BLUE}TEST SUMMARY${NC}"
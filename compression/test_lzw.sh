@@ -22,8 +22,8 @@ SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 LZW_BINARY="$SCRIPT_DIR/lzw"
 TEST_DIR="/tmp/lzw_tests_$$"
 
-# Compile the LZW program if needed
-if [ ! -f "$LZW_BINARY" ]; then
+# Compile the LZW program if needed (or if the source is newer)
+if [ ! -f "$LZW_BINARY" ] || [ "$SCRIPT_DIR/lzw.c" -nt "$LZW_BINARY" ]; then
     echo -e "${YELLOW}Compiling LZW compression program with optimizations...${NC}"
     gcc -o "$LZW_BINARY" "$SCRIPT_DIR/lzw.c" -Wall -O3 -march=native -ffast-math
     echo -e "${GREEN}Compilation successful!${NC}\n"
@@ -106,6 +106,31 @@ run_compression_test() {
     fi
 }
 
+# Function to compress, decompress with -d and compare against the input
+run_roundtrip_test() {
+    local test_name="$1"
+    local input_file="$2"
+
+    local compressed_file="$TEST_DIR/roundtrip.lzw"
+    local restored_file="$TEST_DIR/roundtrip.out"
+
+    if ! "$LZW_BINARY" "$input_file" "$compressed_file" > "$TEST_DIR/lzw_output.txt" 2>&1; then
+        test_result "$test_name" "FAIL" "Compression command failed"
+        return 1
+    fi
+    if ! "$LZW_BINARY" -d "$compressed_file" "$restored_file" > "$TEST_DIR/lzw_output.txt" 2>&1; then
+        test_result "$test_name" "FAIL" "Decompression command failed"
+        return 1
+    fi
+
+    local input_size=$(stat -f%z "$input_file" 2>/dev/null || stat -c%s "$input_file" 2>/dev/null)
+    if cmp -s "$input_file" "$restored_file"; then
+        test_result "$test_name" "PASS" "Restored ${input_size}B exactly"
+    else
+        test_result "$test_name" "FAIL" "Decompressed output differs from the ${input_size}B input"
+    fi
+}
+
 echo -e "${BLUE}================================${NC}"
 echo -e "${BLUE}LZW COMPRESSION TEST SUITE${NC}"
 echo -e "${BLUE}================================${NC}\n"
@@ -203,6 +228,100 @@ echo -e "${YELLOW}Test 14: Very long repeated substring${NC}"
 python3 -c "substring = 'ABCDEFGHIJKLMNOPQRSTUVWXYZ' * 10; print(substring * 20)" > "$TEST_DIR/long_pattern.txt"
 run_compression_test "Very long repeated pattern" "$TEST_DIR/long_pattern.txt" "should_compress"
 
+# TEST 15: Round trip of every file above through lzw -d
+echo -e "${YELLOW}Test 15: Round trips through the decompressor${NC}"
+for file in empty single repetitive classic random words numbers ascii_repeated json_like \
+            mixed_repeated binary xml_like special long_pattern; do
+    run_roundtrip_test "Round trip: $file" "$TEST_DIR/$file.txt"
+done
+
+# TEST 16: Binary data that fills the dictionary
+echo -e "${YELLOW}Test 16: Random binary round trip${NC}"
+head -c 200000 /dev/urandom > "$TEST_DIR/random.bin"
+run_roundtrip_test "Random binary round trip" "$TEST_DIR/random.bin"
+
+# TEST 17: Codes defined by the code just read (cScSc), e.g. "aaaa..."
+echo -e "${YELLOW}Test 17: Self-referencing codes${NC}"
+python3 -c "print('a' * 200 + 'ab' * 300)" > "$TEST_DIR/self_reference.txt"
+run_roundtrip_test "Self-referencing codes" "$TEST_DIR/self_reference.txt"
+
+# TEST 18: Runs long enough to build strings of thousands of bytes
+echo -e "${YELLOW}Test 18: Long single-byte run${NC}"
+head -c 2000000 /dev/zero > "$TEST_DIR/zeros.bin"
+run_roundtrip_test "Long single-byte run" "$TEST_DIR/zeros.bin"
+
+# TEST 19: Corrupt input is rejected
+echo -e "${YELLOW}Test 19: Corrupt stream${NC}"
+printf '\x1f\x9d\x90\xff\x01' > "$TEST_DIR/corrupt.lzw"
+if "$LZW_BINARY" -d "$TEST_DIR/corrupt.lzw" "$TEST_DIR/corrupt.out" > "$TEST_DIR/lzw_output.txt" 2>&1; then
+    test_result "Corrupt stream" "FAIL" "Decompression of an invalid code succeeded"
+else
+    test_result "Corrupt stream" "PASS" "Rejected code 511 as the first code"
+fi
+
+# TEST 20: Input without the .Z header is rejected
+echo -e "${YELLOW}Test 20: Missing header${NC}"
+printf 'plain text' > "$TEST_DIR/no_header.lzw"
+if "$LZW_BINARY" -d "$TEST_DIR/no_header.lzw" "$TEST_DIR/no_header.out" > "$TEST_DIR/lzw_output.txt" 2>&1; then
+    test_result "Missing header" "FAIL" "Decompression without the magic bytes succeeded"
+else
+    test_result "Missing header" "PASS" "Rejected input without the 1F 9D magic"
+fi
+
+# TEST 21: Every code width, on input that fills the dictionary and
+# changes character partway through (exercises widening and CLEAR)
+echo -e "${YELLOW}Test 21: Code widths and dictionary resets${NC}"
+python3 << PYTHON_EOF > "$TEST_DIR/shifting.bin"
+import random, sys
+random.seed(2)
+words = open("$SCRIPT_DIR/lzw.c").read().split()
+text = " ".join(random.choice(words) for _ in range(60000)).encode()
+noise = bytes(random.getrandbits(8) for _ in range(200000))
+sys.stdout.buffer.write(text + noise + text)
+PYTHON_EOF
+for bits in 9 10 12 14 16; do
+    compressed="$TEST_DIR/shifting_$bits.Z"
+    "$LZW_BINARY" -b $bits "$TEST_DIR/shifting.bin" "$compressed" > /dev/null
+    "$LZW_BINARY" -d "$compressed" "$TEST_DIR/shifting.out" > /dev/null
+    compressed_size=$(stat -f%z "$compressed" 2>/dev/null || stat -c%s "$compressed" 2>/dev/null)
+    if cmp -s "$TEST_DIR/shifting.bin" "$TEST_DIR/shifting.out"; then
+        test_result "Round trip with $bits-bit codes" "PASS" "Compressed to ${compressed_size}B"
+    else
+        test_result "Round trip with $bits-bit codes" "FAIL" "Decompressed output differs"
+    fi
+done
+
+# TEST 22: The output is standard .Z; gzip can read it
+echo -e "${YELLOW}Test 22: Compatibility with gzip -d${NC}"
+if command -v gzip > /dev/null; then
+    for bits in 9 12 16; do
+        if gzip -dc < "$TEST_DIR/shifting_$bits.Z" 2>/dev/null | cmp -s - "$TEST_DIR/shifting.bin"; then
+            test_result "gzip -d reads $bits-bit output" "PASS" ""
+        else
+            test_result "gzip -d reads $bits-bit output" "FAIL" "gzip output differs from the input"
+        fi
+    done
+else
+    echo -e "  ${BLUE}gzip not found, skipped${NC}\n"
+fi
+
+# TEST 23: Throughput on a larger text corpus
+echo -e "${YELLOW}Test 23: Throughput${NC}"
+python3 << PYTHON_EOF > "$TEST_DIR/corpus.txt"
+import random
+random.seed(1)
+words = open("$SCRIPT_DIR/lzw.c").read().split()
+print(" ".join(random.choice(words) for _ in range(800000)))
+PYTHON_EOF
+compress_speed=$("$LZW_BINARY" "$TEST_DIR/corpus.txt" "$TEST_DIR/corpus.lzw" | awk '/Throughput/ {print $2}')
+decompress_speed=$("$LZW_BINARY" -d "$TEST_DIR/corpus.lzw" "$TEST_DIR/corpus.out" | awk '/Throughput/ {print $2}')
+corpus_size=$(stat -f%z "$TEST_DIR/corpus.txt" 2>/dev/null || stat -c%s "$TEST_DIR/corpus.txt" 2>/dev/null)
+if cmp -s "$TEST_DIR/corpus.txt" "$TEST_DIR/corpus.out"; then
+    test_result "Throughput (${corpus_size}B text)" "PASS" "Compress: ${compress_speed} MB/s, Decompress: ${decompress_speed} MB/s"
+else
+    test_result "Throughput (${corpus_size}B text)" "FAIL" "Decompressed output differs"
+fi
+
 # Print summary
 echo -e "${BLUE}================================${NC}"
 echo -e "${BLUE}TEST SUMMARY${NC}"